@@ -0,0 +1,124 @@
+/*
+ * Bump allocator for the live tree.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307
+ *                                                                   USA
+ */
+
+#include "dtc.h"
+
+/*
+ * Nodes, properties, labels, markers and reserve entries live as long
+ * as the tree does, which is until dtc exits.  Rather than malloc()ing
+ * each of them, they are carved out of large chunks, one after the
+ * other, and all the chunks are released together at the end.  Objects
+ * dropped while the tree is built (e.g. when nodes are merged) are
+ * simply left in place.
+ */
+
+#define ARENA_CHUNK_SIZE	(64 * 1024)
+#define ARENA_ALIGN		8
+
+struct arena_chunk {
+	struct arena_chunk *next;
+	size_t size;		/* bytes available in mem[] */
+	size_t used;		/* bytes handed out from mem[] */
+	char mem[] __attribute__((aligned(ARENA_ALIGN)));
+};
+
+static struct {
+	struct arena_chunk *chunks;	/* the one being filled is first */
+	size_t nchunks;
+	size_t reserved;		/* total size of all chunks */
+	size_t nallocs;
+	size_t allocated;		/* total size of all objects */
+} arena;
+
+static struct arena_chunk *arena_new_chunk(size_t size)
+{
+	struct arena_chunk *chunk = xmalloc(sizeof(*chunk) + size);
+
+	chunk->size = size;
+	chunk->used = 0;
+	arena.nchunks++;
+	arena.reserved += size;
+
+	return chunk;
+}
+
+void *arena_alloc(size_t size)
+{
+	struct arena_chunk *chunk = arena.chunks;
+	void *p;
+
+	size = ALIGN(size, ARENA_ALIGN);
+	arena.nallocs++;
+	arena.allocated += size;
+
+	/*
+	 * Big objects get a chunk of their own, kept behind the current
+	 * one so as not to waste what is left of it.
+	 */
+	if (size > ARENA_CHUNK_SIZE / 4) {
+		chunk = arena_new_chunk(size);
+		chunk->used = size;
+		if (arena.chunks) {
+			chunk->next = arena.chunks->next;
+			arena.chunks->next = chunk;
+		} else {
+			chunk->next = NULL;
+			arena.chunks = chunk;
+		}
+		return chunk->mem;
+	}
+
+	if (!chunk || chunk->size - chunk->used < size) {
+		chunk = arena_new_chunk(ARENA_CHUNK_SIZE);
+		chunk->next = arena.chunks;
+		arena.chunks = chunk;
+	}
+
+	p = chunk->mem + chunk->used;
+	chunk->used += size;
+
+	return p;
+}
+
+void arena_release(void)
+{
+	struct arena_chunk *chunk, *next;
+
+	for (chunk = arena.chunks; chunk; chunk = next) {
+		next = chunk->next;
+		free(chunk);
+	}
+	memset(&arena, 0, sizeof(arena));
+}
+
+void arena_print_stats(FILE *f)
+{
+	fprintf(f, "arena.objects %zu\n", arena.nallocs);
+	fprintf(f, "arena.bytes %zu\n", arena.allocated);
+	fprintf(f, "arena.chunks %zu\n", arena.nchunks);
+	fprintf(f, "arena.reserved_bytes %zu\n", arena.reserved);
+}
+
+void arena_report(FILE *f)
+{
+	fprintf(f, "arena: %zu objects, %zu bytes in %zu chunks "
+		"(%zu bytes reserved, %zu%% used)\n",
+		arena.nallocs, arena.allocated, arena.nchunks, arena.reserved,
+		arena.reserved ? arena.allocated * 100 / arena.reserved : 0);
+}
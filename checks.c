@@ -18,6 +18,8 @@
  *                                                                   USA
  */
 
+#include <pthread.h>
+
 #include "dtc.h"
 
 #ifdef TRACE_CHECKS
@@ -51,6 +53,18 @@ struct check {
 	bool inprogress;
 	int num_prereqs;
 	struct check **prereq;
+
+	/* Run ahead of its turn, see run_check() */
+	int order;		/* position in check_order[], from 1 */
+	bool speculated;	/* result and messages are waiting */
+	bool buffering;		/* messages go to msgbuf, not stderr */
+	enum checkstatus result;
+	char *msgbuf;
+	int msglen;
+
+	/* For --stats */
+	unsigned long nodes;	/* nodes the check was run on */
+	double time;		/* seconds spent in fn, if collect_stats */
 };
 
 #define CHECK_ENTRY(_nm, _fn, _d, _w, _e, ...)	       \
@@ -72,6 +86,36 @@ struct check {
 #define CHECK(_nm, _fn, _d, ...) \
 	CHECK_ENTRY(_nm, _fn, _d, false, false, __VA_ARGS__)
 
+/* Appends a message to those kept for a check run ahead of its turn */
+static void check_msg_buffer(struct check *c, const char *prefix,
+			     const char *fmt, va_list ap)
+{
+	int plen = strlen(prefix);
+	va_list ap2;
+	int n;
+
+	va_copy(ap2, ap);
+	n = vsnprintf(NULL, 0, fmt, ap2);
+	va_end(ap2);
+
+	c->msgbuf = xrealloc(c->msgbuf, c->msglen + plen + n + 2);
+	memcpy(c->msgbuf + c->msglen, prefix, plen);
+	vsnprintf(c->msgbuf + c->msglen + plen, n + 1, fmt, ap);
+	c->msglen += plen + n;
+	c->msgbuf[c->msglen++] = '\n';
+	c->msgbuf[c->msglen] = '\0';
+}
+
+/* Reports the messages kept for a check */
+static void check_msg_flush(struct check *c)
+{
+	if (c->msglen)
+		fputs(c->msgbuf, stderr);
+	free(c->msgbuf);
+	c->msgbuf = NULL;
+	c->msglen = 0;
+}
+
 static inline void  PRINTF(3, 4) check_msg(struct check *c, struct dt_info *dti,
 					   const char *fmt, ...)
 {
@@ -80,11 +124,19 @@ static inline void  PRINTF(3, 4) check_msg(struct check *c, struct dt_info *dti,
 
 	if ((c->warn && (quiet < 1))
 	    || (c->error && (quiet < 2))) {
-		fprintf(stderr, "%s: %s (%s): ",
-			strcmp(dti->outname, "-") ? dti->outname : "<stdout>",
-			(c->error) ? "ERROR" : "Warning", c->name);
-		vfprintf(stderr, fmt, ap);
-		fprintf(stderr, "\n");
+		char *prefix;
+
+		xasprintf(&prefix, "%s: %s (%s): ",
+			  strcmp(dti->outname, "-") ? dti->outname : "<stdout>",
+			  (c->error) ? "ERROR" : "Warning", c->name);
+		if (c->buffering) {
+			check_msg_buffer(c, prefix, fmt, ap);
+		} else {
+			fputs(prefix, stderr);
+			vfprintf(stderr, fmt, ap);
+			fprintf(stderr, "\n");
+		}
+		free(prefix);
 	}
 	va_end(ap);
 }
@@ -96,21 +148,194 @@ static inline void  PRINTF(3, 4) check_msg(struct check *c, struct dt_info *dti,
 		check_msg((c), dti, __VA_ARGS__);			\
 	} while (0)
 
-static void check_nodes_props(struct check *c, struct dt_info *dti, struct node *node)
+static void check_nodes_props(struct check **batch, int n,
+			      struct dt_info *dti, struct node *node)
 {
 	struct node *child;
+	int i;
 
-	TRACE(c, "%s", node->fullpath);
-	if (c->fn)
-		c->fn(c, dti, node);
+	for (i = 0; i < n; i++) {
+		TRACE(batch[i], "%s", node->fullpath);
+		if (collect_stats) {
+			double start = util_time();
+
+			batch[i]->fn(batch[i], dti, node);
+			batch[i]->time += util_time() - start;
+		} else {
+			batch[i]->fn(batch[i], dti, node);
+		}
+		batch[i]->nodes++;
+	}
 
 	for_each_child(node, child)
-		check_nodes_props(c, dti, child);
+		check_nodes_props(batch, n, dti, child);
+}
+
+/*
+ * Every check that process_checks() may run, in the order run_check()
+ * would first reach each of them: prerequisites before the check itself.
+ */
+static struct check **check_order;
+static int num_check_order;
+
+static int num_check_walks;	/* for --stats */
+
+static void order_check(struct check *c)
+{
+	int i;
+
+	if (c->order)
+		return;
+
+	for (i = 0; i < c->num_prereqs; i++)
+		order_check(c->prereq[i]);
+
+	check_order = xrealloc(check_order,
+			       (num_check_order + 1) * sizeof(*check_order));
+	check_order[num_check_order++] = c;
+	c->order = num_check_order;
+}
+
+static bool check_modifies_tree(struct check *c);
+
+/*
+ * Could c be run now, ahead of its turn, and give the same result it
+ * would when run_check() gets to it?  It must read the tree only, its
+ * prerequisites must all have passed, and no check which changes the
+ * tree can still be due to run before it.
+ */
+static bool check_can_run_ahead(struct check *c)
+{
+	int i;
+
+	if (!c->fn || (c->status != UNCHECKED) || c->speculated
+	    || c->inprogress || check_modifies_tree(c))
+		return false;
+
+	for (i = 0; i < c->num_prereqs; i++)
+		if (c->prereq[i]->status != PASSED)
+			return false;
+
+	for (i = 0; i < c->order - 1; i++)
+		if ((check_order[i]->status == UNCHECKED)
+		    && check_modifies_tree(check_order[i]))
+			return false;
+
+	return true;
+}
+
+/*
+ * With more than one job, the checks of a batch are shared out between
+ * threads: each takes the next check nobody has started and walks the
+ * tree for it.  Only checks which read the tree are ever batched with
+ * others, and each keeps its messages to itself until reported.
+ */
+struct check_pool {
+	struct check **batch;
+	int n, next;
+	pthread_mutex_t lock;
+	struct dt_info *dti;
+};
+
+static void *check_pool_worker(void *arg)
+{
+	struct check_pool *pool = arg;
+	int i;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		i = pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (i >= pool->n)
+			break;
+		check_nodes_props(&pool->batch[i], 1, pool->dti,
+				  pool->dti->dt);
+	}
+
+	return NULL;
+}
+
+static void run_check_pool(struct check **batch, int n, struct dt_info *dti)
+{
+	struct check_pool pool = {
+		.batch = batch,
+		.n = n,
+		.next = 0,
+		.dti = dti,
+	};
+	int i, err, nthreads = ((check_jobs < n) ? check_jobs : n) - 1;
+	pthread_t *threads = xmalloc(nthreads * sizeof(*threads));
+
+	pthread_mutex_init(&pool.lock, NULL);
+
+	for (i = 0; i < nthreads; i++) {
+		err = pthread_create(&threads[i], NULL, check_pool_worker,
+				     &pool);
+		if (err)
+			die("Couldn't start check thread: %s\n",
+			    strerror(err));
+	}
+
+	check_pool_worker(&pool);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_mutex_destroy(&pool.lock);
+	free(threads);
+}
+
+/*
+ * Runs check c over the tree.  Checks later in check_order[] which are
+ * ready are run in the same walk, each node being handed to them in
+ * order; their results and messages are kept until run_check() reaches
+ * them, so nothing is reported any earlier or in any other order.
+ */
+static void run_check_batch(struct check *c, struct dt_info *dti)
+{
+	struct check **batch;
+	int i, n = 0;
+
+	batch = xmalloc((num_check_order + 1) * sizeof(*batch));
+	if (c->fn)
+		batch[n++] = c;
+	if (!check_modifies_tree(c))
+		for (i = c->order; i < num_check_order; i++)
+			if (check_can_run_ahead(check_order[i])) {
+				check_order[i]->buffering = true;
+				batch[n++] = check_order[i];
+			}
+
+	if ((check_jobs > 1) && (n > 1)) {
+		c->buffering = true;
+		run_check_pool(batch, n, dti);
+		num_check_walks += n;
+	} else if (n) {
+		check_nodes_props(batch, n, dti, dti->dt);
+		num_check_walks++;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct check *b = batch[i];
+
+		if (!b->buffering)
+			continue;
+		b->buffering = false;
+		if (b == c) {
+			check_msg_flush(c);
+			continue;
+		}
+		b->speculated = true;
+		b->result = b->status;
+		b->status = UNCHECKED;
+	}
+
+	free(batch);
 }
 
 static bool run_check(struct check *c, struct dt_info *dti)
 {
-	struct node *dt = dti->dt;
 	bool error = false;
 	int i;
 
@@ -134,7 +359,13 @@ static bool run_check(struct check *c, struct dt_info *dti)
 	if (c->status != UNCHECKED)
 		goto out;
 
-	check_nodes_props(c, dti, dt);
+	if (c->speculated) {
+		c->speculated = false;
+		c->status = c->result;
+		check_msg_flush(c);
+	} else {
+		run_check_batch(c, dti);
+	}
 
 	if (c->status == UNCHECKED)
 		c->status = PASSED;
@@ -198,6 +429,204 @@ static void check_is_cell(struct check *c, struct dt_info *dti,
 #define ERROR_IF_NOT_CELL(nm, propname) \
 	ERROR(nm, check_is_cell, (propname))
 
+/*
+ * Symbol tables shared by the checks
+ */
+
+static unsigned int symbol_hash(const char *name)
+{
+	unsigned int h = 2166136261U;
+
+	while (*name)
+		h = (h ^ (unsigned char)*name++) * 16777619U;
+
+	return h;
+}
+
+/*
+ * Scratch space for counting repeated names in a list of siblings, so
+ * the duplicate name checks don't compare every pair.  For each entry i,
+ * count_later_duplicates() sets dups[i] to how many of the entries after
+ * it with counted set have the same name.  Each check using it has its
+ * own, as its data, so they can run at the same time.
+ */
+struct name_count {
+	const char *name;	/* NULL if the slot is empty */
+	int count;
+};
+
+struct sibling_names {
+	const char **names;
+	bool *counted;
+	int *dups;
+	int max;
+	struct name_count *slots;
+	unsigned int nslots;
+};
+
+static struct sibling_names node_siblings, property_siblings;
+
+static void siblings_add(struct sibling_names *siblings, int i,
+			 const char *name, bool counted)
+{
+	if (i >= siblings->max) {
+		siblings->max = siblings->max ? 2 * siblings->max : 64;
+		siblings->names = xrealloc(siblings->names,
+			siblings->max * sizeof(*siblings->names));
+		siblings->counted = xrealloc(siblings->counted,
+			siblings->max * sizeof(*siblings->counted));
+		siblings->dups = xrealloc(siblings->dups,
+			siblings->max * sizeof(*siblings->dups));
+	}
+
+	siblings->names[i] = name;
+	siblings->counted[i] = counted;
+}
+
+static void count_later_duplicates(struct sibling_names *siblings, int n)
+{
+	unsigned int mask;
+	int i;
+
+	if (2 * n > siblings->nslots) {
+		free(siblings->slots);
+		siblings->nslots = 64;
+		while (siblings->nslots < 2 * n)
+			siblings->nslots *= 2;
+		siblings->slots = xmalloc(siblings->nslots
+					 * sizeof(*siblings->slots));
+	}
+	mask = siblings->nslots - 1;
+	memset(siblings->slots, 0, siblings->nslots * sizeof(*siblings->slots));
+
+	for (i = n - 1; i >= 0; i--) {
+		unsigned int h = symbol_hash(siblings->names[i]) & mask;
+		struct name_count *slot = &siblings->slots[h];
+
+		while (slot->name && !streq(slot->name, siblings->names[i])) {
+			h = (h + 1) & mask;
+			slot = &siblings->slots[h];
+		}
+
+		slot->name = siblings->names[i];
+		siblings->dups[i] = slot->count;
+		if (siblings->counted[i])
+			slot->count++;
+	}
+}
+
+/*
+ * The first owner of each label in the tree: a node, else a property,
+ * else a marker within a property value, each in tree order.  Built in
+ * one pass over the tree the first time it is needed for a given tree.
+ */
+enum label_owner {
+	LABEL_NODE,
+	LABEL_PROP,
+	LABEL_MARKER,
+};
+
+struct label_entry {
+	const char *label;	/* NULL if the slot is empty */
+	enum label_owner owner;
+	struct node *node;
+	struct property *prop;
+	struct marker *mark;
+};
+
+static struct {
+	struct node *dt;	/* tree the table was built for */
+	struct label_entry *slots;
+	unsigned int nslots, nused;
+} labels;
+
+static struct label_entry *label_slot(const char *label)
+{
+	unsigned int mask = labels.nslots - 1;
+	unsigned int i = symbol_hash(label) & mask;
+
+	while (labels.slots[i].label && !streq(labels.slots[i].label, label))
+		i = (i + 1) & mask;
+
+	return &labels.slots[i];
+}
+
+static void label_add(const char *label, enum label_owner owner,
+		      struct node *node, struct property *prop,
+		      struct marker *mark)
+{
+	struct label_entry *e;
+
+	if (2 * (labels.nused + 1) > labels.nslots) {
+		struct label_entry *old = labels.slots;
+		unsigned int i, oldn = labels.nslots;
+
+		labels.nslots = oldn ? 2 * oldn : 64;
+		labels.slots = xmalloc(labels.nslots * sizeof(*labels.slots));
+		memset(labels.slots, 0, labels.nslots * sizeof(*labels.slots));
+		for (i = 0; i < oldn; i++)
+			if (old[i].label)
+				*label_slot(old[i].label) = old[i];
+		free(old);
+	}
+
+	e = label_slot(label);
+	if (!e->label)
+		labels.nused++;
+	else if (e->owner <= owner)
+		return;
+
+	e->label = label;
+	e->owner = owner;
+	e->node = node;
+	e->prop = prop;
+	e->mark = mark;
+}
+
+static void labels_add_tree(struct node *node)
+{
+	struct node *child;
+	struct property *prop;
+	struct label *l;
+
+	for_each_label(node->labels, l)
+		label_add(l->label, LABEL_NODE, node, NULL, NULL);
+
+	for_each_property(node, prop) {
+		struct marker *m = prop->val.markers;
+
+		for_each_label(prop->labels, l)
+			label_add(l->label, LABEL_PROP, node, prop, NULL);
+
+		for_each_marker_of_type(m, LABEL)
+			label_add(m->ref, LABEL_MARKER, node, prop, m);
+	}
+
+	for_each_child(node, child)
+		labels_add_tree(child);
+}
+
+static struct label_entry *label_lookup(struct dt_info *dti,
+					const char *label)
+{
+	struct label_entry *e;
+
+	if (labels.dt != dti->dt) {
+		if (labels.slots)
+			memset(labels.slots, 0,
+			       labels.nslots * sizeof(*labels.slots));
+		labels.nused = 0;
+		labels.dt = dti->dt;
+		labels_add_tree(dti->dt);
+	}
+
+	if (!labels.nused)
+		return NULL;
+
+	e = label_slot(label);
+	return e->label ? e : NULL;
+}
+
 /*
  * Structural check functions
  */
@@ -205,34 +634,59 @@ static void check_is_cell(struct check *c, struct dt_info *dti,
 static void check_duplicate_node_names(struct check *c, struct dt_info *dti,
 				       struct node *node)
 {
-	struct node *child, *child2;
+	struct sibling_names *siblings = c->data;
+	struct node *child;
+	int i, n = 0;
 
-	for_each_child(node, child)
-		for (child2 = child->next_sibling;
-		     child2;
-		     child2 = child2->next_sibling)
-			if (streq(child->name, child2->name))
-				FAIL(c, dti, "Duplicate node name %s",
-				     child->fullpath);
+	for_each_child_withdel(node, child)
+		siblings_add(siblings, n++, child->name, true);
+
+	if (n < 2)
+		return;
+
+	count_later_duplicates(siblings, n);
+
+	i = 0;
+	for_each_child_withdel(node, child) {
+		int dups = siblings->dups[i++];
+
+		if (child->deleted)
+			continue;
+		while (dups--)
+			FAIL(c, dti, "Duplicate node name %s",
+			     child->fullpath);
+	}
 }
-ERROR(duplicate_node_names, check_duplicate_node_names, NULL);
+ERROR(duplicate_node_names, check_duplicate_node_names, &node_siblings);
 
 static void check_duplicate_property_names(struct check *c, struct dt_info *dti,
 					   struct node *node)
 {
-	struct property *prop, *prop2;
+	struct sibling_names *siblings = c->data;
+	struct property *prop;
+	int i, n = 0;
 
-	for_each_property(node, prop) {
-		for (prop2 = prop->next; prop2; prop2 = prop2->next) {
-			if (prop2->deleted)
-				continue;
-			if (streq(prop->name, prop2->name))
-				FAIL(c, dti, "Duplicate property name %s in %s",
-				     prop->name, node->fullpath);
-		}
+	for_each_property_withdel(node, prop)
+		siblings_add(siblings, n++, prop->name, !prop->deleted);
+
+	if (n < 2)
+		return;
+
+	count_later_duplicates(siblings, n);
+
+	i = 0;
+	for_each_property_withdel(node, prop) {
+		int dups = siblings->dups[i++];
+
+		if (prop->deleted)
+			continue;
+		while (dups--)
+			FAIL(c, dti, "Duplicate property name %s in %s",
+			     prop->name, node->fullpath);
 	}
 }
-ERROR(duplicate_property_names, check_duplicate_property_names, NULL);
+ERROR(duplicate_property_names, check_duplicate_property_names,
+      &property_siblings);
 
 #define LOWERCASE	"abcdefghijklmnopqrstuvwxyz"
 #define UPPERCASE	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -353,22 +807,18 @@ static void check_duplicate_label(struct check *c, struct dt_info *dti,
 				  const char *label, struct node *node,
 				  struct property *prop, struct marker *mark)
 {
-	struct node *dt = dti->dt;
-	struct node *othernode = NULL;
-	struct property *otherprop = NULL;
-	struct marker *othermark = NULL;
-
-	othernode = get_node_by_label(dt, label);
-
-	if (!othernode)
-		otherprop = get_property_by_label(dt, label, &othernode);
-	if (!othernode)
-		othermark = get_marker_label(dt, label, &othernode,
-					       &otherprop);
+	struct label_entry *first = label_lookup(dti, label);
+	struct node *othernode;
+	struct property *otherprop;
+	struct marker *othermark;
 
-	if (!othernode)
+	if (!first)
 		return;
 
+	othernode = first->node;
+	otherprop = first->prop;
+	othermark = first->mark;
+
 	if ((othernode != node) || (otherprop != prop) || (othermark != mark))
 		FAIL(c, dti, "Duplicate label '%s' on " DESCLABEL_FMT
 		     " and " DESCLABEL_FMT,
@@ -476,7 +926,7 @@ static void check_explicit_phandles(struct check *c, struct dt_info *dti,
 		return;
 	}
 
-	node->phandle = phandle;
+	set_node_phandle(node, phandle);
 }
 ERROR(explicit_phandles, check_explicit_phandles, NULL);
 
@@ -504,7 +954,6 @@ static void check_name_properties(struct check *c, struct dt_info *dti,
 		*pp = prop->next;
 		free(prop->name);
 		data_free(prop->val);
-		free(prop);
 	}
 }
 ERROR_IF_NOT_STRING(name_is_string, "name");
@@ -539,7 +988,7 @@ static void fixup_phandle_references(struct check *c, struct dt_info *dti,
 				continue;
 			}
 
-			phandle = get_node_phandle(dt, refnode);
+			phandle = get_node_phandle(dti, refnode);
 			*((fdt32_t *)(prop->val.val + m->offset)) = cpu_to_fdt32(phandle);
 		}
 	}
@@ -990,6 +1439,28 @@ static struct check *check_table[] = {
 	&always_fail,
 };
 
+/*
+ * Checks which change the tree.  Whatever runs after one of these must
+ * see the tree as it leaves it, so they are never run ahead of their
+ * turn, nor is anything that comes after them.
+ */
+static struct check *modifying_checks[] = {
+	&name_properties,
+	&explicit_phandles,
+	&phandle_references, &path_references,
+};
+
+static bool check_modifies_tree(struct check *c)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(modifying_checks); i++)
+		if (modifying_checks[i] == c)
+			return true;
+
+	return false;
+}
+
 static void enable_warning_error(struct check *c, bool warn, bool error)
 {
 	int i;
@@ -1056,6 +1527,13 @@ void process_checks(bool force, struct dt_info *dti)
 	int i;
 	int error = 0;
 
+	for (i = 0; i < ARRAY_SIZE(check_table); i++) {
+		struct check *c = check_table[i];
+
+		if (c->warn || c->error)
+			order_check(c);
+	}
+
 	for (i = 0; i < ARRAY_SIZE(check_table); i++) {
 		struct check *c = check_table[i];
 
@@ -1074,3 +1552,24 @@ void process_checks(bool force, struct dt_info *dti)
 		}
 	}
 }
+
+void print_check_stats(FILE *f)
+{
+	static const char *const statusname[] = {
+		[UNCHECKED] = "unchecked",
+		[PREREQ] = "prereq",
+		[PASSED] = "passed",
+		[FAILED] = "failed",
+	};
+	int i;
+
+	fprintf(f, "checks.walks %d\n", num_check_walks);
+	for (i = 0; i < num_check_order; i++) {
+		struct check *c = check_order[i];
+
+		fprintf(f, "check.%s.status %s\n", c->name,
+			statusname[c->status]);
+		fprintf(f, "check.%s.nodes %lu\n", c->name, c->nodes);
+		fprintf(f, "check.%s.seconds %.6f\n", c->name, c->time);
+	}
+}
@@ -18,8 +18,15 @@
  *                                                                   USA
  */
 
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "dtc.h"
 
+/* Files smaller than this are read by data_map_file() rather than mapped */
+#define DATA_MAP_MIN	65536
+
 void data_free(struct data d)
 {
 	struct marker *m, *nm;
@@ -28,32 +35,57 @@ void data_free(struct data d)
 	while (m) {
 		nm = m->next;
 		free(m->ref);
-		free(m);
 		m = nm;
 	}
 
-	if (d.val)
+	if (d.val && !data_is_borrowed(d))
 		free(d.val);
 }
 
+/*
+ * Makes room for xlen more bytes.  The buffer at least doubles each time
+ * it has to grow, so appending a byte or cell at a time to a long value
+ * costs amortized constant time rather than a realloc() per append.
+ */
 struct data data_grow_for(struct data d, int xlen)
 {
-	struct data nd;
 	int newsize;
 
-	if (xlen == 0)
+	if ((d.len + xlen) <= d.size)
 		return d;
 
-	nd = d;
+	newsize = 2 * d.size;
+	if (newsize < d.len + xlen)
+		newsize = d.len + xlen;
 
-	newsize = xlen;
+	if (data_is_borrowed(d)) {
+		char *val = xmalloc(newsize);
+
+		memcpy(val, d.val, d.len);
+		d.val = val;
+	} else {
+		d.val = xrealloc(d.val, newsize);
+	}
+	d.size = newsize;
+
+	return d;
+}
 
-	while ((d.len + xlen) > newsize)
-		newsize *= 2;
+/* Gives back the room left over from growing, once d is complete */
+struct data data_shrink(struct data d)
+{
+	if ((d.size == d.len) || data_is_borrowed(d))
+		return d;
 
-	nd.val = xrealloc(d.val, newsize);
+	if (d.len) {
+		d.val = xrealloc(d.val, d.len);
+	} else {
+		free(d.val);
+		d.val = NULL;
+	}
+	d.size = d.len;
 
-	return nd;
+	return d;
 }
 
 struct data data_copy_mem(const char *mem, int len)
@@ -117,6 +149,56 @@ struct data data_copy_file(FILE *f, size_t maxlen)
 	return d;
 }
 
+/*
+ * Makes a value of the len bytes at mem without copying them.  The caller
+ * keeps mem in place for as long as the value is used; the value itself is
+ * never written in place, appending to it first moves it to the heap.
+ */
+struct data data_borrow(char *mem, int len)
+{
+	struct data d = empty_data;
+
+	if (len) {
+		d.val = mem;
+		d.len = len;
+	}
+
+	return d;
+}
+
+/*
+ * Like data_copy_file(), but a large regular file is mapped instead of
+ * read, and the result borrows the mapping.  The mapping is never undone:
+ * it lasts, like the rest of the tree, until dtc exits.
+ */
+struct data data_map_file(FILE *f, size_t maxlen)
+{
+	struct stat st;
+	off_t off, base;
+	size_t len;
+	char *p;
+
+	off = ftello(f);
+	if ((off < 0) || (fstat(fileno(f), &st) != 0)
+	    || !S_ISREG(st.st_mode) || (st.st_size <= off))
+		return data_copy_file(f, maxlen);
+
+	len = st.st_size - off;
+	if (len > maxlen)
+		len = maxlen;
+	if ((len < DATA_MAP_MIN) || (len > INT_MAX))
+		return data_copy_file(f, maxlen);
+
+	/* mmap() wants a page aligned offset */
+	base = off & ~((off_t)sysconf(_SC_PAGESIZE) - 1);
+	p = mmap(NULL, len + (off - base), PROT_READ, MAP_PRIVATE,
+		 fileno(f), base);
+	if (p == MAP_FAILED)
+		return data_copy_file(f, maxlen);
+
+	return data_borrow(p + (off - base), len);
+}
+
 struct data data_append_data(struct data d, const void *p, int len)
 {
 	d = data_grow_for(d, len);
@@ -156,11 +238,22 @@ struct data data_merge(struct data d1, struct data d2)
 	struct data d;
 	struct marker *m2 = d2.markers;
 
-	d = data_append_markers(data_append_data(d1, d2.val, d2.len), m2);
-
-	/* Adjust for the length of d1 */
-	for_each_marker(m2)
-		m2->offset += d1.len;
+	if (!d1.len && d2.len) {
+		/* Take over d2's bytes rather than copying them into d1 */
+		d = d2;
+		d.markers = d1.markers;
+		d1.markers = NULL;
+		data_free(d1);
+		d2.val = NULL;
+		d = data_append_markers(d, m2);
+	} else {
+		d = data_append_markers(data_append_data(d1, d2.val, d2.len),
+					m2);
+
+		/* Adjust for the length of d1 */
+		for_each_marker(m2)
+			m2->offset += d1.len;
+	}
 
 	d2.markers = NULL; /* So data_free() doesn't clobber them */
 	data_free(d2);
@@ -241,7 +334,7 @@ struct data data_add_marker(struct data d, enum markertype type, char *ref)
 {
 	struct marker *m;
 
-	m = xmalloc(sizeof(*m));
+	m = arena_alloc(sizeof(*m));
 	m->offset = d.len;
 	m->type = type;
 	m->ref = ref;
@@ -282,7 +282,7 @@ propdata:
 					    (unsigned long long)$6, $4.val,
 					    strerror(errno));
 
-			d = data_copy_file(f, $8);
+			d = data_map_file(f, $8);
 
 			$$ = data_merge($1, d);
 			fclose(f);
@@ -292,7 +292,7 @@ propdata:
 			FILE *f = srcfile_relative_open($4.val, NULL);
 			struct data d = empty_data;
 
-			d = data_copy_file(f, -1);
+			d = data_map_file(f, -1);
 
 			$$ = data_merge($1, d);
 			fclose(f);
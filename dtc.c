@@ -18,6 +18,7 @@
  *                                                                   USA
  */
 
+#include <sys/resource.h>
 #include <sys/stat.h>
 
 #include "dtc.h"
@@ -35,6 +36,113 @@ int phandle_format = PHANDLE_EPAPR;	/* Use linux,phandle or phandle properties *
 int generate_symbols;	/* enable symbols & fixup support */
 int generate_fixups;		/* suppress generation of fixups on symbol support */
 int auto_label_aliases;		/* auto generate labels -> aliases */
+int check_jobs = 1;		/* threads to run checks in */
+int collect_stats;		/* time phases and checks for --stats */
+int share_suffixes;		/* share name bytes regardless of order */
+
+/*
+ * --stats: time taken by each phase of the run, reported at the end
+ */
+static struct {
+	const char *name;
+	double seconds;
+} phase_times[16];
+static int num_phase_times;
+static double phase_start;
+
+static void end_phase(const char *name)
+{
+	double now;
+
+	if (!collect_stats)
+		return;
+
+	now = util_time();
+	assert(num_phase_times < ARRAY_SIZE(phase_times));
+	phase_times[num_phase_times].name = name;
+	phase_times[num_phase_times].seconds = now - phase_start;
+	num_phase_times++;
+	phase_start = now;
+}
+
+struct tree_counts {
+	unsigned long nodes, properties, labels, value_bytes;
+};
+
+static void count_tree(struct node *node, struct tree_counts *counts)
+{
+	struct property *prop;
+	struct node *child;
+	struct label *l;
+
+	counts->nodes++;
+	for_each_label(node->labels, l)
+		counts->labels++;
+
+	for_each_property(node, prop) {
+		counts->properties++;
+		counts->value_bytes += prop->val.len;
+		for_each_label(prop->labels, l)
+			counts->labels++;
+	}
+
+	for_each_child(node, child)
+		count_tree(child, counts);
+}
+
+static void print_stats(FILE *f, struct dt_info *dti, FILE *outf, bool blob)
+{
+	struct tree_counts counts = {0};
+	struct reserve_info *re;
+	struct rusage usage;
+	unsigned long reserves = 0;
+	double total = 0;
+	long outlen;
+	int i;
+
+	for (i = 0; i < num_phase_times; i++) {
+		fprintf(f, "phase.%s.seconds %.6f\n", phase_times[i].name,
+			phase_times[i].seconds);
+		total += phase_times[i].seconds;
+	}
+	fprintf(f, "total.seconds %.6f\n", total);
+
+	print_check_stats(f);
+
+	if (dti->dt)
+		count_tree(dti->dt, &counts);
+	for (re = dti->reservelist; re; re = re->next)
+		reserves++;
+	fprintf(f, "tree.nodes %lu\n", counts.nodes);
+	fprintf(f, "tree.properties %lu\n", counts.properties);
+	fprintf(f, "tree.labels %lu\n", counts.labels);
+	fprintf(f, "tree.value_bytes %lu\n", counts.value_bytes);
+	fprintf(f, "tree.reserve_entries %lu\n", reserves);
+
+	arena_print_stats(f);
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		/* ru_maxrss is in KiB, except on OS X where it is in bytes */
+		fprintf(f, "memory.peak_rss_kb %ld\n",
+#ifdef __APPLE__
+			usage.ru_maxrss / 1024
+#else
+			usage.ru_maxrss
+#endif
+			);
+
+	if (blob) {
+		fprintf(f, "output.rsvmap_bytes %d\n", dti->blob_rsvmap_size);
+		fprintf(f, "output.struct_bytes %d\n", dti->blob_struct_size);
+		fprintf(f, "output.strings_bytes %d\n",
+			dti->blob_strings_size);
+		fprintf(f, "output.total_bytes %d\n", dti->blob_totalsize);
+	} else {
+		fflush(outf);
+		outlen = ftell(outf);
+		if (outlen >= 0)
+			fprintf(f, "output.total_bytes %ld\n", outlen);
+	}
+}
 
 static int is_power_of_2(int x)
 {
@@ -59,10 +167,14 @@ static void fill_fullpaths(struct node *tree, const char *prefix)
 }
 
 /* Usage related data. */
+#define OPT_VERBOSE	0x100	/* long option only, -v is taken */
+#define OPT_STATS	0x101
+#define OPT_CHECK	0x102
+#define OPT_SHARE_SUFFIXES	0x103
 #define FDT_VERSION(version)	_FDT_VERSION(version)
 #define _FDT_VERSION(version)	#version
 static const char usage_synopsis[] = "dtc [options] <input file>";
-static const char usage_short_opts[] = "qI:O:o:V:d:R:S:p:a:fb:i:H:sW:E:@Ahv";
+static const char usage_short_opts[] = "qI:O:o:V:d:R:S:p:a:fb:i:H:sW:E:j:@Ahv";
 static struct option const usage_long_opts[] = {
 	{"quiet",            no_argument, NULL, 'q'},
 	{"in-format",         a_argument, NULL, 'I'},
@@ -81,8 +193,13 @@ static struct option const usage_long_opts[] = {
 	{"phandle",           a_argument, NULL, 'H'},
 	{"warning",           a_argument, NULL, 'W'},
 	{"error",             a_argument, NULL, 'E'},
+	{"jobs",              a_argument, NULL, 'j'},
 	{"symbols",	     no_argument, NULL, '@'},
 	{"auto-alias",       no_argument, NULL, 'A'},
+	{"verbose",          no_argument, NULL, OPT_VERBOSE},
+	{"stats",            no_argument, NULL, OPT_STATS},
+	{"check",            no_argument, NULL, OPT_CHECK},
+	{"share-suffixes",   no_argument, NULL, OPT_SHARE_SUFFIXES},
 	{"help",             no_argument, NULL, 'h'},
 	{"version",          no_argument, NULL, 'v'},
 	{NULL,               no_argument, NULL, 0x0},
@@ -114,8 +231,14 @@ static const char * const usage_opts_help[] = {
 	 "\t\tboth   - Both \"linux,phandle\" and \"phandle\" properties",
 	"\n\tEnable/disable warnings (prefix with \"no-\")",
 	"\n\tEnable/disable errors (prefix with \"no-\")",
+	"\n\tRun checks in up to <number> threads",
 	"\n\tEnable generation of symbols",
 	"\n\tEnable auto-alias of labels",
+	"\n\tReport memory usage statistics on stderr",
+	"\n\tReport times, counts and sizes on stderr, one \"name value\" per line",
+	"\n\tRead and check a dtb even when only its layout or boot cpu changes",
+	"\n\tStore a property name inside any longer name it ends, even one that comes later\n"
+	 "\t(smaller strings block, but offsets differ from other dtc versions)",
 	"\n\tPrint this help and exit",
 	"\n\tPrint version and exit",
 	NULL,
@@ -165,6 +288,43 @@ static const char *guess_input_format(const char *fname, const char *fallback)
 	return guess_type_by_name(fname, fallback);
 }
 
+static void process_tree(struct dt_info *dti, bool force, bool sort)
+{
+	fill_fullpaths(dti->dt, "");
+	end_phase("fullpaths");
+	process_checks(force, dti);
+	end_phase("checks");
+
+	/* on a plugin, generate by default */
+	if (dti->dtsflags & DTSF_PLUGIN) {
+		generate_fixups = 1;
+	}
+
+	if (auto_label_aliases) {
+		generate_label_tree(dti, "aliases", false);
+		end_phase("aliases");
+	}
+
+	if (generate_symbols) {
+		generate_label_tree(dti, "__symbols__", true);
+		end_phase("symbols");
+	}
+
+	if (generate_fixups) {
+		generate_fixups_tree(dti, "__fixups__");
+		generate_local_fixups_tree(dti, "__local_fixups__");
+		end_phase("fixups");
+	}
+
+	if (sort) {
+		sort_tree(dti);
+		end_phase("sort");
+	}
+
+	/* The tree is final: drop the room left in values for appending */
+	shrink_tree_values(dti);
+}
+
 int main(int argc, char *argv[])
 {
 	struct dt_info *dti;
@@ -172,7 +332,8 @@ int main(int argc, char *argv[])
 	const char *outform = NULL;
 	const char *outname = "-";
 	const char *depname = NULL;
-	bool force = false, sort = false;
+	bool force = false, sort = false, verbose = false, check = false;
+	bool relayout;
 	const char *arg;
 	int opt;
 	FILE *outf = NULL;
@@ -255,12 +416,31 @@ int main(int argc, char *argv[])
 			parse_checks_option(false, true, optarg);
 			break;
 
+		case 'j':
+			check_jobs = strtol(optarg, NULL, 0);
+			if (check_jobs < 1)
+				die("Invalid argument \"%s\" to -j option\n",
+				    optarg);
+			break;
+
 		case '@':
 			generate_symbols = 1;
 			break;
 		case 'A':
 			auto_label_aliases = 1;
 			break;
+		case OPT_VERBOSE:
+			verbose = true;
+			break;
+		case OPT_STATS:
+			collect_stats = 1;
+			break;
+		case OPT_CHECK:
+			check = true;
+			break;
+		case OPT_SHARE_SUFFIXES:
+			share_suffixes = 1;
+			break;
 
 		case 'h':
 			usage(NULL);
@@ -299,14 +479,29 @@ int main(int argc, char *argv[])
 				outform = "dts";
 		}
 	}
+
+	/*
+	 * Changing only the layout or boot cpu of a dtb doesn't need the
+	 * tree: libfdt relays out the blob as it is, unless asked to check.
+	 */
+	relayout = streq(inform, "dtb") && streq(outform, "dtb")
+		&& (outversion == DEFAULT_FDT_VERSION)
+		&& (minsize || padsize || alignsize
+		    || (cmdline_boot_cpuid != -1))
+		&& !check && !sort && !reservenum
+		&& !generate_symbols && !auto_label_aliases;
+
+	phase_start = util_time();
+
 	if (streq(inform, "dts"))
 		dti = dt_from_source(arg);
 	else if (streq(inform, "fs"))
 		dti = dt_from_fs(arg);
 	else if(streq(inform, "dtb"))
-		dti = dt_from_blob(arg);
+		dti = dt_from_blob(arg, outname, relayout);
 	else
 		die("Unknown input format \"%s\"\n", inform);
+	end_phase("parse");
 
 	dti->outname = outname;
 
@@ -318,27 +513,8 @@ int main(int argc, char *argv[])
 	if (cmdline_boot_cpuid != -1)
 		dti->boot_cpuid_phys = cmdline_boot_cpuid;
 
-	fill_fullpaths(dti->dt, "");
-	process_checks(force, dti);
-
-	/* on a plugin, generate by default */
-	if (dti->dtsflags & DTSF_PLUGIN) {
-		generate_fixups = 1;
-	}
-
-	if (auto_label_aliases)
-		generate_label_tree(dti, "aliases", false);
-
-	if (generate_symbols)
-		generate_label_tree(dti, "__symbols__", true);
-
-	if (generate_fixups) {
-		generate_fixups_tree(dti, "__fixups__");
-		generate_local_fixups_tree(dti, "__local_fixups__");
-	}
-
-	if (sort)
-		sort_tree(dti);
+	if (dti->dt)
+		process_tree(dti, force, sort);
 
 	if (streq(outname, "-")) {
 		outf = stdout;
@@ -360,6 +536,13 @@ int main(int argc, char *argv[])
 	} else {
 		die("Unknown output format \"%s\"\n", outform);
 	}
+	end_phase("output");
+
+	if (collect_stats)
+		print_stats(stderr, dti, outf, streq(outform, "dtb"));
+	if (verbose)
+		arena_report(stderr);
+	arena_release();
 
 	exit(0);
 }
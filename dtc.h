@@ -58,6 +58,9 @@ extern int phandle_format;	/* Use linux,phandle or phandle properties */
 extern int generate_symbols;	/* generate symbols for nodes with labels */
 extern int generate_fixups;	/* generate fixups */
 extern int auto_label_aliases;	/* auto generate labels -> aliases */
+extern int check_jobs;		/* threads to run checks in */
+extern int collect_stats;	/* time phases and checks for --stats */
+extern int share_suffixes;	/* share name bytes regardless of order */
 
 #define PHANDLE_LEGACY	0x1
 #define PHANDLE_EPAPR	0x2
@@ -71,6 +74,12 @@ typedef uint32_t cell_t;
 
 #define ALIGN(x, a)	(((x) + (a) - 1) & ~((a) - 1))
 
+/* Arena for live tree objects, released all at once */
+void *arena_alloc(size_t size);
+void arena_release(void);
+void arena_report(FILE *f);
+void arena_print_stats(FILE *f);
+
 /* Data blobs */
 enum markertype {
 	REF_PHANDLE,
@@ -87,6 +96,8 @@ struct  marker {
 
 struct data {
 	int len;
+	int size;		/* bytes allocated at val, len or more;
+				 * 0 if val is borrowed, see data_borrow() */
 	char *val;
 	struct marker *markers;
 };
@@ -94,6 +105,8 @@ struct data {
 
 #define empty_data ((struct data){ 0 /* all .members = 0 or NULL */ })
 
+#define data_is_borrowed(d)	((d).val && !(d).size)
+
 #define for_each_marker(m) \
 	for (; (m); (m) = (m)->next)
 #define for_each_marker_of_type(m, t) \
@@ -103,10 +116,13 @@ struct data {
 void data_free(struct data d);
 
 struct data data_grow_for(struct data d, int xlen);
+struct data data_shrink(struct data d);
 
 struct data data_copy_mem(const char *mem, int len);
 struct data data_copy_escape_string(const char *s, int len);
 struct data data_copy_file(FILE *f, size_t len);
+struct data data_borrow(char *mem, int len);
+struct data data_map_file(FILE *f, size_t len);
 
 struct data data_append_data(struct data d, const void *p, int len);
 struct data data_insert_at_marker(struct data d, struct marker *m,
@@ -190,6 +206,8 @@ struct node {
 	for_each_child_withdel(n, c) \
 		if (!(c)->deleted)
 
+struct dt_info;
+
 void add_label(struct label **labels, char *label);
 void delete_labels(struct label **labels);
 
@@ -226,7 +244,8 @@ struct node *get_node_by_path(struct node *tree, const char *path);
 struct node *get_node_by_label(struct node *tree, const char *label);
 struct node *get_node_by_phandle(struct node *tree, cell_t phandle);
 struct node *get_node_by_ref(struct node *tree, const char *ref);
-cell_t get_node_phandle(struct node *root, struct node *node);
+cell_t get_node_phandle(struct dt_info *dti, struct node *node);
+void set_node_phandle(struct node *node, cell_t phandle);
 
 uint32_t guess_boot_cpuid(struct node *tree);
 
@@ -252,7 +271,19 @@ struct dt_info {
 	struct reserve_info *reservelist;
 	uint32_t boot_cpuid_phys;
 	struct node *dt;		/* the device tree */
+	char *blob;			/* or, without a tree, the input blob
+					 * to relay out, see dt_from_blob() */
 	const char *outname;		/* filename being written to, "-" for stdout */
+
+	/* phandle allocation, see get_node_phandle() */
+	cell_t *used_phandles;		/* sorted, once allocation starts */
+	int num_used_phandles, max_used_phandles;
+	int next_used_phandle;
+	cell_t next_phandle;		/* 0 until allocation starts */
+
+	/* Blocks of the last blob written by dt_to_blob(), for --stats */
+	int blob_rsvmap_size, blob_struct_size, blob_strings_size;
+	int blob_totalsize;
 };
 
 /* DTS version flags definitions */
@@ -263,6 +294,7 @@ struct dt_info *build_dt_info(unsigned int dtsflags,
 			      struct reserve_info *reservelist,
 			      struct node *tree, uint32_t boot_cpuid_phys);
 void sort_tree(struct dt_info *dti);
+void shrink_tree_values(struct dt_info *dti);
 void generate_label_tree(struct dt_info *dti, char *name, bool allocph);
 void generate_fixups_tree(struct dt_info *dti, char *name);
 void generate_local_fixups_tree(struct dt_info *dti, char *name);
@@ -271,13 +303,15 @@ void generate_local_fixups_tree(struct dt_info *dti, char *name);
 
 void parse_checks_option(bool warn, bool error, const char *arg);
 void process_checks(bool force, struct dt_info *dti);
+void print_check_stats(FILE *f);
 
 /* Flattened trees */
 
 void dt_to_blob(FILE *f, struct dt_info *dti, int version);
 void dt_to_asm(FILE *f, struct dt_info *dti, int version);
 
-struct dt_info *dt_from_blob(const char *fname);
+struct dt_info *dt_from_blob(const char *fname, const char *outname,
+			     bool relayout);
 
 /* Tree source */
 
@@ -166,7 +166,7 @@ static bool valid_header(char *p, off_t len)
 	    fdt_magic(p) != FDT_MAGIC ||
 	    fdt_version(p) > MAX_VERSION ||
 	    fdt_last_comp_version(p) > MAX_VERSION ||
-	    fdt_totalsize(p) >= len ||
+	    fdt_totalsize(p) > len ||
 	    fdt_off_dt_struct(p) >= len ||
 	    fdt_off_dt_strings(p) >= len)
 		return 0;
@@ -204,7 +204,7 @@ int main(int argc, char *argv[])
 		usage("missing input filename");
 	file = argv[optind];
 
-	buf = utilfdt_read_len(file, &len);
+	buf = utilfdt_map_len(file, 0, &len);
 	if (!buf)
 		die("could not read: %s\n", file);
 
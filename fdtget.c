@@ -25,6 +25,7 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -238,6 +239,248 @@ static int show_data_for_item(const void *blob, struct display_info *disp,
 	return err;
 }
 
+/*
+ * Cache of resolved node paths, so that a batch of queries about the same
+ * part of the tree walks down to it only once.  Every prefix of an
+ * absolute path that gets resolved is remembered (failures included), so
+ * a lookup only walks the components past the longest prefix seen before.
+ */
+struct path_cache_entry {
+	char *path;
+	int len;
+	int offset;
+};
+
+struct path_cache {
+	struct path_cache_entry *slots;	/* path is NULL if empty */
+	unsigned int nslots;
+	unsigned int nused;
+};
+
+#define PATH_CACHE_MIN_SLOTS	64
+
+static unsigned int path_cache_hash(const char *path, int len)
+{
+	unsigned int h = 2166136261U;
+
+	while (len--)
+		h = (h ^ (unsigned char)*path++) * 16777619U;
+
+	return h;
+}
+
+static void path_cache_init(struct path_cache *cache)
+{
+	cache->nslots = PATH_CACHE_MIN_SLOTS;
+	cache->nused = 0;
+	cache->slots = xmalloc(cache->nslots * sizeof(*cache->slots));
+	memset(cache->slots, 0, cache->nslots * sizeof(*cache->slots));
+}
+
+static void path_cache_free(struct path_cache *cache)
+{
+	unsigned int i;
+
+	for (i = 0; i < cache->nslots; i++)
+		free(cache->slots[i].path);
+	free(cache->slots);
+}
+
+static struct path_cache_entry *path_cache_slot(struct path_cache *cache,
+						const char *path, int len)
+{
+	unsigned int mask = cache->nslots - 1;
+	unsigned int i = path_cache_hash(path, len) & mask;
+	struct path_cache_entry *e;
+
+	for (e = &cache->slots[i]; e->path; e = &cache->slots[i]) {
+		if (e->len == len && !memcmp(e->path, path, len))
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return e;
+}
+
+static void path_cache_put(struct path_cache *cache, const char *path,
+			   int len, int offset)
+{
+	struct path_cache_entry *e;
+
+	/* Keep the table at most half full */
+	if (2 * (cache->nused + 1) > cache->nslots) {
+		struct path_cache_entry *old = cache->slots;
+		unsigned int i, oldn = cache->nslots;
+
+		cache->nslots *= 2;
+		cache->slots = xmalloc(cache->nslots * sizeof(*cache->slots));
+		memset(cache->slots, 0, cache->nslots * sizeof(*cache->slots));
+		for (i = 0; i < oldn; i++)
+			if (old[i].path)
+				*path_cache_slot(cache, old[i].path,
+						 old[i].len) = old[i];
+		free(old);
+	}
+
+	e = path_cache_slot(cache, path, len);
+	if (!e->path) {
+		e->path = xmalloc(len);
+		memcpy(e->path, path, len);
+		e->len = len;
+		cache->nused++;
+	}
+	e->offset = offset;
+}
+
+/**
+ * Look up the offset of a node, like fdt_path_offset(), using the cache
+ *
+ * @param blob		FDT blob
+ * @param cache		Paths resolved so far
+ * @param path		Path of the node, or an alias
+ * @return offset of the node, or -FDT_ERR... if not found
+ */
+static int cached_path_offset(const void *blob, struct path_cache *cache,
+			      const char *path)
+{
+	struct path_cache_entry *e;
+	int len = strlen(path);
+	int offset = 0;		/* the root node */
+	int p, q;
+
+	/* Aliases are resolved by libfdt, and only cached as a whole */
+	if (*path != '/') {
+		e = path_cache_slot(cache, path, len);
+		if (e->path)
+			return e->offset;
+		offset = fdt_path_offset(blob, path);
+		path_cache_put(cache, path, len, offset);
+		return offset;
+	}
+
+	/* Find the longest prefix, ending on a component, already resolved */
+	for (p = len; p > 0; p--) {
+		if (p < len && path[p] != '/')
+			continue;
+		e = path_cache_slot(cache, path, p);
+		if (e->path) {
+			offset = e->offset;
+			break;
+		}
+	}
+
+	/* Walk down from there, the way fdt_path_offset() does */
+	while (offset >= 0 && p < len) {
+		while (path[p] == '/')
+			p++;
+		if (p == len)
+			break;
+		for (q = p; q < len && path[q] != '/'; q++)
+			;
+		offset = fdt_subnode_offset_namelen(blob, offset, path + p,
+						    q - p);
+		path_cache_put(cache, path, q, offset);
+		p = q;
+	}
+
+	return offset;
+}
+
+/**
+ * Answer a single query: show a property, or list a node's contents
+ *
+ * @param blob		FDT blob
+ * @param disp		Display information / options
+ * @param cache		Paths resolved so far
+ * @param path		Path of the node to look at
+ * @param prop		Name of property to display, or NULL if none
+ * @return 0 if ok, -ve on error
+ */
+static int do_query(const void *blob, struct display_info *disp,
+		    struct path_cache *cache, const char *path,
+		    const char *prop)
+{
+	int node;
+
+	node = cached_path_offset(blob, cache, path);
+	if (node < 0) {
+		if (disp->default_val) {
+			puts(disp->default_val);
+			return 0;
+		}
+		report_error(path, node);
+		return -1;
+	}
+
+	return show_data_for_item(blob, disp, node, prop);
+}
+
+/**
+ * Answer the queries in a file, one per line
+ *
+ * Each line holds a node path followed, unless properties or subnodes
+ * are being listed, by a property name.  Blank lines and lines starting
+ * with '#' are skipped.  Reading from stdin, the answer to each query is
+ * flushed out before the next one is read, so that fdtget can be driven
+ * interactively by another program.
+ *
+ * @param blob		FDT blob
+ * @param disp		Display information / options
+ * @param cache		Paths resolved so far
+ * @param filename	File to read the queries from, or - for stdin
+ * @param args_per_step	Number of words in each query
+ * @return 0 if ok, -ve on error
+ */
+static int do_query_file(const void *blob, struct display_info *disp,
+			 struct path_cache *cache, const char *filename,
+			 int args_per_step)
+{
+	const char *seps = " \t\r\n";
+	FILE *f = stdin;
+	char *line = NULL;
+	size_t size = 0;
+	char *arg[3];
+	int lineno = 0, n, ret = 0;
+
+	if (strcmp(filename, "-") != 0) {
+		f = fopen(filename, "r");
+		if (!f) {
+			fprintf(stderr, "Couldn't open query file '%s': %s\n",
+				filename, strerror(errno));
+			return -1;
+		}
+	}
+
+	while (!ret && getline(&line, &size, f) >= 0) {
+		lineno++;
+		for (n = 0; n < 3; n++) {
+			arg[n] = strtok(n ? NULL : line, seps);
+			if (!arg[n])
+				break;
+		}
+		if (!n || *arg[0] == '#')
+			continue;
+		if (n != args_per_step) {
+			fprintf(stderr, "Error at '%s' line %d: expected %s\n",
+				filename, lineno, args_per_step == 1 ?
+				"<node>" : "<node> <property>");
+			ret = -1;
+			break;
+		}
+
+		ret = do_query(blob, disp, cache, arg[0],
+			       args_per_step == 1 ? NULL : arg[1]);
+		if (f == stdin)
+			fflush(stdout);
+	}
+
+	free(line);
+	if (f != stdin)
+		fclose(f);
+
+	return ret;
+}
+
 /**
  * Run the main fdtget operation, given a filename and valid arguments
  *
@@ -245,42 +488,44 @@ static int show_data_for_item(const void *blob, struct display_info *disp,
  * @param filename	Filename of blob file
  * @param arg		List of arguments to process
  * @param arg_count	Number of arguments
+ * @param args_per_step	Number of arguments in each query
+ * @param query_file	File to read more queries from, or NULL if none
  * @return 0 if ok, -ve on error
  */
 static int do_fdtget(struct display_info *disp, const char *filename,
-		     char **arg, int arg_count, int args_per_step)
+		     char **arg, int arg_count, int args_per_step,
+		     const char *query_file)
 {
+	struct path_cache cache;
 	char *blob;
-	const char *prop;
-	int i, node;
+	off_t len;
+	int i, ret = 0;
 
-	blob = utilfdt_read(filename);
+	blob = utilfdt_map_len(filename, 0, &len);
 	if (!blob)
 		return -1;
 
-	for (i = 0; i + args_per_step <= arg_count; i += args_per_step) {
-		node = fdt_path_offset(blob, arg[i]);
-		if (node < 0) {
-			if (disp->default_val) {
-				puts(disp->default_val);
-				continue;
-			} else {
-				report_error(arg[i], node);
-				free(blob);
-				return -1;
-			}
-		}
-		prop = args_per_step == 1 ? NULL : arg[i + 1];
-
-		if (show_data_for_item(blob, disp, node, prop)) {
-			free(blob);
-			return -1;
-		}
+	/* Don't let libfdt wander off the end of the mapping */
+	if (len < sizeof(struct fdt_header)
+	    || (!fdt_check_header(blob) && fdt_totalsize(blob) > len)) {
+		report_error(filename, -FDT_ERR_TRUNCATED);
+		utilfdt_unmap(blob, len);
+		return -1;
 	}
 
-	free(blob);
+	path_cache_init(&cache);
+	for (i = 0; !ret && i + args_per_step <= arg_count;
+	     i += args_per_step)
+		ret = do_query(blob, disp, &cache, arg[i],
+			       args_per_step == 1 ? NULL : arg[i + 1]);
+	if (!ret && query_file)
+		ret = do_query_file(blob, disp, &cache, query_file,
+				    args_per_step);
+	path_cache_free(&cache);
 
-	return 0;
+	utilfdt_unmap(blob, len);
+
+	return ret;
 }
 
 /* Usage related data. */
@@ -288,15 +533,17 @@ static const char usage_synopsis[] =
 	"read values from device tree\n"
 	"	fdtget <options> <dt file> [<node> <property>]...\n"
 	"	fdtget -p <options> <dt file> [<node> ]...\n"
+	"	fdtget -f <query file> <options> <dt file>\n"
 	"\n"
 	"Each value is printed on a new line.\n"
 	USAGE_TYPE_MSG;
-static const char usage_short_opts[] = "t:pld:" USAGE_COMMON_SHORT_OPTS;
+static const char usage_short_opts[] = "t:pld:f:" USAGE_COMMON_SHORT_OPTS;
 static struct option const usage_long_opts[] = {
 	{"type",              a_argument, NULL, 't'},
 	{"properties",       no_argument, NULL, 'p'},
 	{"list",             no_argument, NULL, 'l'},
 	{"default",           a_argument, NULL, 'd'},
+	{"file",              a_argument, NULL, 'f'},
 	USAGE_COMMON_LONG_OPTS,
 };
 static const char * const usage_opts_help[] = {
@@ -304,6 +551,7 @@ static const char * const usage_opts_help[] = {
 	"List properties for each node",
 	"List subnodes for each node",
 	"Default value to display when the property is missing",
+	"Also answer the queries in this file, one per line (- for stdin)",
 	USAGE_COMMON_OPTS_HELP
 };
 
@@ -311,6 +559,7 @@ int main(int argc, char *argv[])
 {
 	int opt;
 	char *filename = NULL;
+	const char *query_file = NULL;
 	struct display_info disp;
 	int args_per_step = 2;
 
@@ -341,6 +590,10 @@ int main(int argc, char *argv[])
 		case 'd':
 			disp.default_val = optarg;
 			break;
+
+		case 'f':
+			query_file = optarg;
+			break;
 		}
 	}
 
@@ -353,14 +606,14 @@ int main(int argc, char *argv[])
 	argc -= optind;
 
 	/* Allow no arguments, and silently succeed */
-	if (!argc)
+	if (!argc && !query_file)
 		return 0;
 
 	/* Check for node, property arguments */
 	if (args_per_step == 2 && (argc % 2))
 		usage("must have an even number of arguments");
 
-	if (do_fdtget(&disp, filename, argv, argc, args_per_step))
+	if (do_fdtget(&disp, filename, argv, argc, args_per_step, query_file))
 		return 1;
 	return 0;
 }
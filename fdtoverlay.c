@@ -26,7 +26,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <alloca.h>
 
 #include <libfdt.h>
 
@@ -54,49 +53,108 @@ static const char * const usage_opts_help[] = {
 
 int verbose = 0;
 
+/* Maps an overlay blob, which gets modified, checking it is all there */
+static char *map_overlay(const char *filename, off_t *len)
+{
+	char *blob;
+
+	blob = utilfdt_map_len(filename, 1, len);
+	if (!blob) {
+		fprintf(stderr, "\nFailed to read overlay %s\n", filename);
+		return NULL;
+	}
+
+	if (*len < sizeof(struct fdt_header)
+	    || fdt_totalsize(blob) > *len) {
+		fprintf(stderr, "\nOverlay %s is truncated\n", filename);
+		utilfdt_unmap(blob, *len);
+		return NULL;
+	}
+
+	return blob;
+}
+
 static int do_fdtoverlay(const char *input_filename,
 			 const char *output_filename,
 			 int argc, char *argv[])
 {
-	char *blob = NULL;
-	char **ovblob = NULL;
-	off_t blob_len, ov_len, total_len;
-	int i, ret = -1;
+	char *blob = NULL, *base, *ovblob, *stdin_blob = NULL;
+	off_t base_len, stdin_len = 0, ovlen;
+	uint32_t max_phandle;
+	int i, needed, blob_len, ret = -1;
 
-	blob = utilfdt_read_len(input_filename, &blob_len);
-	if (!blob) {
+	base = utilfdt_map_len(input_filename, 0, &base_len);
+	if (!base) {
 		fprintf(stderr, "\nFailed to read base blob %s\n",
 				input_filename);
 		goto out_err;
 	}
-	ret = 0;
 
-	/* allocate blob pointer array */
-	ovblob = alloca(sizeof(*ovblob) * argc);
-	memset(ovblob, 0, sizeof(*ovblob) * argc);
+	if (base_len < sizeof(struct fdt_header)
+	    || fdt_totalsize(base) > base_len) {
+		fprintf(stderr, "\nBase blob %s is truncated\n",
+				input_filename);
+		goto out_err;
+	}
 
-	/* read and keep track of the overlay blobs */
-	total_len = 0;
+	/*
+	 * Work out exactly how much room the overlays need.  They are
+	 * mapped one at a time, here and again to apply them, except for
+	 * one read from stdin, which is kept.
+	 */
+	needed = 0;
 	for (i = 0; i < argc; i++) {
-		ovblob[i] = utilfdt_read_len(argv[i], &ov_len);
-		if (!ovblob[i]) {
-			fprintf(stderr, "\nFailed to read overlay %s\n",
-					argv[i]);
+		ovblob = map_overlay(argv[i], &ovlen);
+		if (!ovblob) {
+			ret = -1;
 			goto out_err;
 		}
-		total_len += ov_len;
+
+		ret = fdt_overlay_size_needed(base, ovblob);
+		if (strcmp(argv[i], "-") == 0) {
+			stdin_blob = ovblob;
+			stdin_len = ovlen;
+		} else {
+			utilfdt_unmap(ovblob, ovlen);
+		}
+		if (ret < 0) {
+			fprintf(stderr, "\nFailed to size overlay %s (%d)\n",
+					argv[i], ret);
+			goto out_err;
+		}
+		needed += ret;
 	}
 
-	/* grow the blob to worst case */
-	blob_len = fdt_totalsize(blob) + total_len;
-	blob = xrealloc(blob, blob_len);
-	fdt_open_into(blob, blob, blob_len);
+	/* copy the base into a buffer of the final size */
+	blob_len = fdt_totalsize(base) + needed;
+	blob = xmalloc(blob_len);
+	ret = fdt_open_into(base, blob, blob_len);
+	if (ret) {
+		fprintf(stderr, "\nFailed to open base blob %s (%d)\n",
+				input_filename, ret);
+		goto out_err;
+	}
+	utilfdt_unmap(base, base_len);
+	base = NULL;
 
-	/* apply the overlays in sequence */
+	/* apply the overlays in turn */
+	max_phandle = fdt_get_max_phandle(blob);
 	for (i = 0; i < argc; i++) {
-		ret = fdt_overlay_apply(blob, ovblob[i]);
+		if (stdin_blob && (strcmp(argv[i], "-") == 0))
+			ovblob = stdin_blob;
+		else
+			ovblob = map_overlay(argv[i], &ovlen);
+		if (!ovblob) {
+			ret = -1;
+			goto out_err;
+		}
+
+		ret = fdt_overlay_apply_max_phandle(blob, ovblob,
+						    &max_phandle);
+		if (ovblob != stdin_blob)
+			utilfdt_unmap(ovblob, ovlen);
 		if (ret) {
-			fprintf(stderr, "\nFailed to apply %s (%d)\n",
+			fprintf(stderr, "\nFailed to apply overlay %s (%d)\n",
 					argv[i], ret);
 			goto out_err;
 		}
@@ -109,12 +167,10 @@ static int do_fdtoverlay(const char *input_filename,
 				output_filename);
 
 out_err:
-	if (ovblob) {
-		for (i = 0; i < argc; i++) {
-			if (ovblob[i])
-				free(ovblob[i]);
-		}
-	}
+	if (stdin_blob)
+		utilfdt_unmap(stdin_blob, stdin_len);
+	if (base)
+		utilfdt_unmap(base, base_len);
 	free(blob);
 
 	return ret;
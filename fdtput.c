@@ -19,6 +19,7 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -130,9 +131,38 @@ static int encode_value(struct display_info *disp, char **arg, int arg_count,
 
 #define ALIGN(x)		(((x) + (FDT_TAGSIZE) - 1) & ~((FDT_TAGSIZE) - 1))
 
+/**
+ * Make sure there are at least delta bytes free at the end of the blob
+ *
+ * The buffer grows at least twice over each time, so that a long series
+ * of changes only reallocates (and moves) the blob a few times.  It is
+ * packed again before being written out.
+ *
+ * @param fdt		FDT blob to grow
+ * @param delta		Number of free bytes needed
+ * @return the blob, which may have moved
+ */
 static char *_realloc_fdt(char *fdt, int delta)
 {
-	int new_sz = fdt_totalsize(fdt) + delta;
+	int rsvmap_end = fdt_off_mem_rsvmap(fdt) + (fdt_num_mem_rsv(fdt) + 1)
+			 * sizeof(struct fdt_reserve_entry);
+	int used = fdt_off_dt_strings(fdt) + fdt_size_dt_strings(fdt);
+	int old_sz = fdt_totalsize(fdt);
+	int new_sz;
+
+	/*
+	 * Older blobs, or blobs whose blocks are not in the order libfdt's
+	 * read-write functions expect, need fdt_open_into() regardless
+	 */
+	if (fdt_version(fdt) >= 17
+	    && fdt_off_mem_rsvmap(fdt) >= sizeof(struct fdt_header)
+	    && rsvmap_end <= fdt_off_dt_struct(fdt)
+	    && fdt_off_dt_struct(fdt) + fdt_size_dt_struct(fdt)
+		<= fdt_off_dt_strings(fdt)
+	    && used + delta <= old_sz)
+		return fdt;
+
+	new_sz = delta > old_sz ? old_sz + delta : 2 * old_sz;
 	fdt = xrealloc(fdt, new_sz);
 	fdt_open_into(fdt, fdt, new_sz);
 	return fdt;
@@ -325,18 +355,22 @@ static int delete_node(char *blob, const char *node_name)
 	return 0;
 }
 
-static int do_fdtput(struct display_info *disp, const char *filename,
-		    char **arg, int arg_count)
+/**
+ * Carry out a single operation on the fdt.
+ *
+ * @param disp		Display information / options, giving the operation
+ * @param blob		FDT blob to write into, which may be moved
+ * @param arg		Arguments of the operation
+ * @param arg_count	Number of arguments
+ * @return 0 if ok, -1 on error
+ */
+static int do_oper(struct display_info *disp, char **blob, char **arg,
+		   int arg_count)
 {
 	char *value = NULL;
-	char *blob;
 	char *node;
 	int len, ret = 0;
 
-	blob = utilfdt_read(filename);
-	if (!blob)
-		return -1;
-
 	switch (disp->oper) {
 	case OPER_WRITE_PROP:
 		/*
@@ -344,30 +378,211 @@ static int do_fdtput(struct display_info *disp, const char *filename,
 		 * store them into the property.
 		 */
 		assert(arg_count >= 2);
-		if (disp->auto_path && create_paths(&blob, *arg))
+		if (disp->auto_path && create_paths(blob, *arg))
 			return -1;
 		if (encode_value(disp, arg + 2, arg_count - 2, &value, &len) ||
-			store_key_value(&blob, *arg, arg[1], value, len))
+			store_key_value(blob, *arg, arg[1], value, len))
 			ret = -1;
 		break;
 	case OPER_CREATE_NODE:
 		for (; ret >= 0 && arg_count--; arg++) {
 			if (disp->auto_path)
-				ret = create_paths(&blob, *arg);
+				ret = create_paths(blob, *arg);
 			else
-				ret = create_node(&blob, *arg);
+				ret = create_node(blob, *arg);
 		}
 		break;
 	case OPER_REMOVE_NODE:
 		for (; ret >= 0 && arg_count--; arg++)
-			ret = delete_node(blob, *arg);
+			ret = delete_node(*blob, *arg);
 		break;
 	case OPER_DELETE_PROP:
 		node = *arg;
 		for (arg++; ret >= 0 && arg_count-- > 1; arg++)
-			ret = delete_prop(blob, node, *arg);
+			ret = delete_prop(*blob, node, *arg);
 		break;
 	}
+
+	if (value) {
+		free(value);
+	}
+
+	return ret < 0 ? -1 : 0;
+}
+
+/**
+ * Split a line of a script into words, in place.
+ *
+ * Words are separated by white space. Quotes (single or double) group
+ * white space into a word, and a backslash outside single quotes takes
+ * the next character literally. A word starting with '#' begins a
+ * comment.
+ *
+ * @param line		Line to split, which is overwritten
+ * @param wordsp	Array of words, grown as needed
+ * @param sizep		Size of the array
+ * @return number of words, or -1 if a quote is not closed
+ */
+static int split_words(char *line, char ***wordsp, int *sizep)
+{
+	char *in = line, *out;
+	char quote, c;
+	int n = 0;
+
+	for (;;) {
+		while (isspace((unsigned char)*in))
+			in++;
+		if (!*in || *in == '#')
+			break;
+
+		if (n == *sizep) {
+			*sizep = *sizep ? 2 * *sizep : 16;
+			*wordsp = xrealloc(*wordsp, *sizep * sizeof(**wordsp));
+		}
+		(*wordsp)[n++] = out = in;
+
+		for (quote = 0; *in && (quote || !isspace((unsigned char)*in));
+		     in++) {
+			if (*in == quote)
+				quote = 0;
+			else if (!quote && (*in == '"' || *in == '\''))
+				quote = *in;
+			else if (quote != '\'' && *in == '\\' && in[1])
+				*out++ = *++in;
+			else
+				*out++ = *in;
+		}
+		if (quote)
+			return -1;
+
+		c = *in;
+		*out = '\0';
+		if (!c)
+			break;
+		in++;
+	}
+
+	return n;
+}
+
+/* Operations in a script, and the options they correspond to */
+static const struct {
+	const char *name;
+	enum oper_type oper;
+	int min_args;
+} script_opers[] = {
+	{ "set",	OPER_WRITE_PROP,	2 },
+	{ "create",	OPER_CREATE_NODE,	0 },
+	{ "remove",	OPER_REMOVE_NODE,	0 },
+	{ "delete",	OPER_DELETE_PROP,	1 },
+};
+
+/**
+ * Carry out the operations in a script, one per line.
+ *
+ * Each line holds an operation followed by its arguments, as they would
+ * be given on the command line:
+ *
+ *	set [-t<type>] <node> <property> [<value>...]
+ *	create <node>...
+ *	remove <node>...
+ *	delete <node> [<property>...]
+ *
+ * The type and -p given on the command line apply to every line.
+ *
+ * @param disp		Display information / options
+ * @param blob		FDT blob to write into, which may be moved
+ * @param filename	Script to read, or - for stdin
+ * @return 0 if ok, -1 on error
+ */
+static int do_script(struct display_info *disp, char **blob,
+		     const char *filename)
+{
+	struct display_info line_disp;
+	FILE *f = stdin;
+	char *line = NULL, **words = NULL, **arg;
+	const char *err, *type;
+	size_t size = 0;
+	int nwords = 0;
+	int lineno = 0, n, i, ret = 0;
+
+	if (strcmp(filename, "-") != 0) {
+		f = fopen(filename, "r");
+		if (!f) {
+			fprintf(stderr, "Couldn't open script '%s': %s\n",
+				filename, strerror(errno));
+			return -1;
+		}
+	}
+
+	while (!ret && getline(&line, &size, f) >= 0) {
+		lineno++;
+		n = split_words(line, &words, &nwords);
+		if (!n)
+			continue;
+
+		err = NULL;
+		for (i = 0; i < ARRAY_SIZE(script_opers); i++)
+			if (n > 0 && !strcmp(words[0], script_opers[i].name))
+				break;
+		if (n < 0)
+			err = "unterminated quote";
+		else if (i == ARRAY_SIZE(script_opers))
+			err = "unknown operation";
+
+		line_disp = *disp;
+		arg = words + 1;
+		n--;
+		if (!err && script_opers[i].oper == OPER_WRITE_PROP
+		    && n && !strncmp(*arg, "-t", 2)) {
+			if ((*arg)[2])
+				type = *arg + 2;
+			else if (n > 1)
+				type = *++arg, n--;
+			else
+				type = NULL;
+			arg++, n--;
+			if (!type || utilfdt_decode_type(type, &line_disp.type,
+							 &line_disp.size))
+				err = "invalid type string";
+		}
+		if (!err && n < script_opers[i].min_args)
+			err = "missing arguments";
+
+		if (err) {
+			fprintf(stderr, "Error at '%s' line %d: %s\n",
+				filename, lineno, err);
+			ret = -1;
+			break;
+		}
+
+		line_disp.oper = script_opers[i].oper;
+		ret = do_oper(&line_disp, blob, arg, n);
+	}
+
+	free(words);
+	free(line);
+	if (f != stdin)
+		fclose(f);
+
+	return ret;
+}
+
+static int do_fdtput(struct display_info *disp, const char *filename,
+		    char **arg, int arg_count, const char *script)
+{
+	char *blob;
+	int ret = 0;
+
+	blob = utilfdt_read(filename);
+	if (!blob)
+		return -1;
+
+	/* Everything is applied in memory: the file is written just once */
+	if (arg_count || !script)
+		ret = do_oper(disp, &blob, arg, arg_count);
+	if (ret >= 0 && script)
+		ret = do_script(disp, &blob, script);
 	if (ret >= 0) {
 		fdt_pack(blob);
 		ret = utilfdt_write(filename, blob);
@@ -375,10 +590,6 @@ static int do_fdtput(struct display_info *disp, const char *filename,
 
 	free(blob);
 
-	if (value) {
-		free(value);
-	}
-
 	return ret;
 }
 
@@ -389,10 +600,11 @@ static const char usage_synopsis[] =
 	"	fdtput -c <options> <dt file> [<node>...]\n"
 	"	fdtput -r <options> <dt file> [<node>...]\n"
 	"	fdtput -d <options> <dt file> <node> [<property>...]\n"
+	"	fdtput -f <script> <options> <dt file>\n"
 	"\n"
 	"The command line arguments are joined together into a single value.\n"
 	USAGE_TYPE_MSG;
-static const char usage_short_opts[] = "crdpt:v" USAGE_COMMON_SHORT_OPTS;
+static const char usage_short_opts[] = "crdpt:vf:" USAGE_COMMON_SHORT_OPTS;
 static struct option const usage_long_opts[] = {
 	{"create",           no_argument, NULL, 'c'},
 	{"remove",	     no_argument, NULL, 'r'},
@@ -400,6 +612,7 @@ static struct option const usage_long_opts[] = {
 	{"auto-path",        no_argument, NULL, 'p'},
 	{"type",              a_argument, NULL, 't'},
 	{"verbose",          no_argument, NULL, 'v'},
+	{"file",              a_argument, NULL, 'f'},
 	USAGE_COMMON_LONG_OPTS,
 };
 static const char * const usage_opts_help[] = {
@@ -409,6 +622,7 @@ static const char * const usage_opts_help[] = {
 	"Automatically create nodes as needed for the node path",
 	"Type of data",
 	"Display each value decoded from command line",
+	"Also carry out the operations in this file, one per line (- for stdin)",
 	USAGE_COMMON_OPTS_HELP
 };
 
@@ -417,6 +631,7 @@ int main(int argc, char *argv[])
 	int opt;
 	struct display_info disp;
 	char *filename = NULL;
+	const char *script = NULL;
 
 	memset(&disp, '\0', sizeof(disp));
 	disp.size = -1;
@@ -452,6 +667,10 @@ int main(int argc, char *argv[])
 		case 'v':
 			disp.verbose = 1;
 			break;
+
+		case 'f':
+			script = optarg;
+			break;
 		}
 	}
 
@@ -463,18 +682,19 @@ int main(int argc, char *argv[])
 	argv += optind;
 	argc -= optind;
 
-	if (disp.oper == OPER_WRITE_PROP) {
+	/* With a script, the command line need not have an operation */
+	if (disp.oper == OPER_WRITE_PROP && (argc || !script)) {
 		if (argc < 1)
 			usage("missing node");
 		if (argc < 2)
 			usage("missing property");
 	}
 
-	if (disp.oper == OPER_DELETE_PROP)
+	if (disp.oper == OPER_DELETE_PROP && (argc || !script))
 		if (argc < 1)
 			usage("missing node");
 
-	if (do_fdtput(&disp, filename, argv, argc))
+	if (do_fdtput(&disp, filename, argv, argc, script))
 		return 1;
 	return 0;
 }
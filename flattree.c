@@ -18,6 +18,12 @@
  *                                                                   USA
  */
 
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "libfdt.h"
 #include "dtc.h"
 #include "srcpos.h"
 
@@ -57,36 +63,140 @@ struct emitter {
 	void (*property)(void *, struct label *labels);
 };
 
+#ifndef IOV_MAX
+#define IOV_MAX		16
+#endif
+
+/*
+ * Writes out the n pieces of a blob in one go, without first gathering
+ * them into one buffer.
+ */
+static void write_blob(FILE *f, struct iovec *iov, int n)
+{
+	ssize_t ret;
+
+	if (fflush(f) != 0)
+		die("Error writing device tree blob: %s\n", strerror(errno));
+
+	while (n > 0) {
+		ret = writev(fileno(f), iov, n < IOV_MAX ? n : IOV_MAX);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			die("Error writing device tree blob: %s\n",
+			    strerror(errno));
+		}
+		if (ret == 0)
+			die("Short write on device tree blob\n");
+
+		/* Skip past what was written */
+		for (; n > 0 && (size_t)ret >= iov->iov_len; iov++, n--)
+			ret -= iov->iov_len;
+		if (n > 0) {
+			iov->iov_base = (char *)iov->iov_base + ret;
+			iov->iov_len -= ret;
+		}
+	}
+}
+
+/*
+ * The binary emitter streams the blob to the output.  It goes over the
+ * tree twice: first with f NULL, only to size the structure block and fill
+ * the string table for the header, then to write it.  Small pieces are
+ * gathered in buf; values of a buffer or more (firmware images from
+ * /incbin/, typically) go out straight from where they live.
+ */
+#define FLAT_BUF_SIZE		65536
+
+struct flat_writer {
+	FILE *f;		/* NULL while sizing */
+	int len;		/* bytes emitted so far */
+	int buflen;
+	char buf[FLAT_BUF_SIZE];
+};
+
+static void flat_flush(struct flat_writer *fw)
+{
+	struct iovec iov = { .iov_base = fw->buf, .iov_len = fw->buflen };
+
+	if (fw->buflen)
+		write_blob(fw->f, &iov, 1);
+	fw->buflen = 0;
+}
+
+static void flat_write(struct flat_writer *fw, const void *p, int len)
+{
+	fw->len += len;
+	if (!fw->f)
+		return;
+
+	while (len > 0) {
+		int n = FLAT_BUF_SIZE - fw->buflen;
+
+		if (n > len)
+			n = len;
+		memcpy(fw->buf + fw->buflen, p, n);
+		fw->buflen += n;
+		p = (const char *)p + n;
+		len -= n;
+
+		if (fw->buflen == FLAT_BUF_SIZE)
+			flat_flush(fw);
+	}
+}
+
+static void flat_write_zeroes(struct flat_writer *fw, int len)
+{
+	static const char zeroes[256];
+
+	while (len > 0) {
+		int n = len < sizeof(zeroes) ? len : sizeof(zeroes);
+
+		flat_write(fw, zeroes, n);
+		len -= n;
+	}
+}
+
 static void bin_emit_cell(void *e, cell_t val)
 {
-	struct data *dtbuf = e;
+	fdt32_t beval = cpu_to_fdt32(val);
 
-	*dtbuf = data_append_cell(*dtbuf, val);
+	flat_write(e, &beval, sizeof(beval));
 }
 
 static void bin_emit_string(void *e, const char *str, int len)
 {
-	struct data *dtbuf = e;
-
 	if (len == 0)
 		len = strlen(str);
 
-	*dtbuf = data_append_data(*dtbuf, str, len);
-	*dtbuf = data_append_byte(*dtbuf, '\0');
+	flat_write(e, str, len);
+	flat_write_zeroes(e, 1);
 }
 
 static void bin_emit_align(void *e, int a)
 {
-	struct data *dtbuf = e;
+	struct flat_writer *fw = e;
 
-	*dtbuf = data_append_align(*dtbuf, a);
+	flat_write_zeroes(fw, ALIGN(fw->len, a) - fw->len);
 }
 
 static void bin_emit_data(void *e, struct data d)
 {
-	struct data *dtbuf = e;
+	struct flat_writer *fw = e;
+	struct iovec iov[2];
 
-	*dtbuf = data_append_data(*dtbuf, d.val, d.len);
+	if (!fw->f || (d.len < FLAT_BUF_SIZE)) {
+		flat_write(fw, d.val, d.len);
+		return;
+	}
+
+	iov[0].iov_base = fw->buf;
+	iov[0].iov_len = fw->buflen;
+	iov[1].iov_base = d.val;
+	iov[1].iov_len = d.len;
+	write_blob(fw->f, iov, 2);
+	fw->buflen = 0;
+	fw->len += d.len;
 }
 
 static void bin_emit_beginnode(void *e, struct label *labels)
@@ -232,23 +342,196 @@ static struct emitter asm_emitter = {
 	.property = asm_emit_property,
 };
 
-static int stringtable_insert(struct data *d, const char *str)
+/*
+ * String table used while flattening.  Names are interned through an
+ * open-addressed hash of string block offsets, so each insertion costs
+ * a hash and (usually) a single strcmp rather than a scan of the whole
+ * block.
+ *
+ * Every tail of an inserted string is hashed as well, so a name which
+ * is a suffix of an earlier one (e.g. "phandle" after "linux,phandle")
+ * reuses its bytes.  This gives exactly the offsets produced by the old
+ * linear byte-by-byte scan.
+ *
+ * With sharing asked for (dtc's --share-suffixes), all the tree's
+ * property names are inserted up front, those ending in the same
+ * characters longest first, so that a name also shares the bytes of a
+ * longer one which only comes later in the tree.  The string block can
+ * only get smaller, but the offsets no longer match the old scan's.
+ */
+struct stringtable {
+	struct data data;
+	int *slots;		/* string block offset + 1, 0 if empty */
+	unsigned int nslots;
+	unsigned int nused;
+};
+
+#define STRINGTABLE_MIN_SLOTS	64
+
+static unsigned int stringtable_hash(const char *str)
 {
-	int i;
+	unsigned int h = 2166136261U;
+
+	while (*str)
+		h = (h ^ (unsigned char)*str++) * 16777619U;
+
+	return h;
+}
+
+/* Releases the hash index, handing back ownership of the string block */
+static struct data stringtable_finish(struct stringtable *st)
+{
+	free(st->slots);
+	st->slots = NULL;
+	st->nslots = st->nused = 0;
+
+	return st->data;
+}
+
+static int *stringtable_slot(struct stringtable *st, const char *str,
+			     unsigned int hash)
+{
+	unsigned int mask = st->nslots - 1;
+	unsigned int i = hash & mask;
+
+	while (st->slots[i]) {
+		if (streq(st->data.val + st->slots[i] - 1, str))
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return &st->slots[i];
+}
+
+static void stringtable_grow(struct stringtable *st)
+{
+	int *oldslots = st->slots;
+	unsigned int oldn = st->nslots;
+	unsigned int i;
+
+	st->nslots *= 2;
+	st->slots = xmalloc(st->nslots * sizeof(*st->slots));
+	memset(st->slots, 0, st->nslots * sizeof(*st->slots));
+
+	for (i = 0; i < oldn; i++) {
+		const char *s;
+
+		if (!oldslots[i])
+			continue;
+		s = st->data.val + oldslots[i] - 1;
+		*stringtable_slot(st, s, stringtable_hash(s)) = oldslots[i];
+	}
+
+	free(oldslots);
+}
 
-	/* FIXME: do this more efficiently? */
+static void stringtable_add(struct stringtable *st, int offset)
+{
+	const char *s = st->data.val + offset;
+	int *slot;
+
+	/* Keep the load factor at or below 1/2 */
+	if ((st->nused + 1) * 2 > st->nslots)
+		stringtable_grow(st);
 
-	for (i = 0; i < d->len; i++) {
-		if (streq(str, d->val + i))
-			return i;
+	slot = stringtable_slot(st, s, stringtable_hash(s));
+	if (!*slot) {
+		*slot = offset + 1;
+		st->nused++;
 	}
+}
 
-	*d = data_append_data(*d, str, strlen(str)+1);
-	return i;
+static int stringtable_insert(struct stringtable *st, const char *str)
+{
+	int *slot = stringtable_slot(st, str, stringtable_hash(str));
+	int len = strlen(str);
+	int offset, i;
+
+	if (*slot)
+		return *slot - 1;
+
+	offset = st->data.len;
+	st->data = data_append_data(st->data, str, len+1);
+
+	for (i = 0; i <= len; i++)
+		stringtable_add(st, offset + i);
+
+	return offset;
+}
+
+static int count_propnames(struct node *tree)
+{
+	struct property *prop;
+	struct node *child;
+	int n = 0;
+
+	for_each_property(tree, prop)
+		n++;
+	for_each_child(tree, child)
+		n += count_propnames(child);
+
+	return n;
+}
+
+static const char **collect_propnames(struct node *tree, const char **names)
+{
+	struct property *prop;
+	struct node *child;
+
+	for_each_property(tree, prop)
+		*names++ = prop->name;
+	for_each_child(tree, child)
+		names = collect_propnames(child, names);
+
+	return names;
+}
+
+/* Orders names by their reversed characters, descending, so that each
+ * name comes after every longer name it is a suffix of */
+static int cmp_propname_tails(const void *ax, const void *bx)
+{
+	const char *a = *(const char * const *)ax;
+	const char *b = *(const char * const *)bx;
+	int alen = strlen(a), blen = strlen(b);
+
+	while (alen && blen) {
+		unsigned char ca = a[--alen], cb = b[--blen];
+
+		if (ca != cb)
+			return cb - ca;
+	}
+
+	return blen - alen;
+}
+
+static void stringtable_init(struct stringtable *st, struct node *tree,
+			     bool share)
+{
+	const char **names;
+	int n, i;
+
+	st->data = empty_data;
+	st->nslots = STRINGTABLE_MIN_SLOTS;
+	st->nused = 0;
+	st->slots = xmalloc(st->nslots * sizeof(*st->slots));
+	memset(st->slots, 0, st->nslots * sizeof(*st->slots));
+
+	if (!share)
+		return;
+
+	n = count_propnames(tree);
+	if (!n)
+		return;
+	names = xmalloc(n * sizeof(*names));
+	collect_propnames(tree, names);
+	qsort(names, n, sizeof(*names), cmp_propname_tails);
+	for (i = 0; i < n; i++)
+		stringtable_insert(st, names[i]);
+	free(names);
 }
 
 static void flatten_tree(struct node *tree, struct emitter *emit,
-			 void *etarget, struct data *strbuf,
+			 void *etarget, struct stringtable *strtab,
 			 struct version_info *vi)
 {
 	struct property *prop;
@@ -273,7 +556,7 @@ static void flatten_tree(struct node *tree, struct emitter *emit,
 		if (streq(prop->name, "name"))
 			seen_name_prop = true;
 
-		nameoff = stringtable_insert(strbuf, prop->name);
+		nameoff = stringtable_insert(strtab, prop->name);
 
 		emit->property(etarget, prop->labels);
 		emit->cell(etarget, prop->val.len);
@@ -289,7 +572,7 @@ static void flatten_tree(struct node *tree, struct emitter *emit,
 	if ((vi->flags & FTF_NAMEPROPS) && !seen_name_prop) {
 		emit->property(etarget, NULL);
 		emit->cell(etarget, tree->basenamelen+1);
-		emit->cell(etarget, stringtable_insert(strbuf, "name"));
+		emit->cell(etarget, stringtable_insert(strtab, "name"));
 
 		if ((vi->flags & FTF_VARALIGN) && ((tree->basenamelen+1) >= 8))
 			emit->align(etarget, 8);
@@ -299,7 +582,7 @@ static void flatten_tree(struct node *tree, struct emitter *emit,
 	}
 
 	for_each_child(tree, child) {
-		flatten_tree(child, emit, etarget, strbuf, vi);
+		flatten_tree(child, emit, etarget, strtab, vi);
 	}
 
 	emit->endnode(etarget, tree->labels);
@@ -357,16 +640,86 @@ static void make_fdt_header(struct fdt_header *fdt,
 		fdt->size_dt_struct = cpu_to_fdt32(dtsize);
 }
 
+/* Returns the padding the user asked for after a blob of totalsize bytes */
+static int blob_padlen(int totalsize)
+{
+	int padlen = 0;
+
+	if (minsize > 0) {
+		padlen = minsize - totalsize;
+		if (padlen < 0) {
+			padlen = 0;
+			if (quiet < 1)
+				fprintf(stderr,
+					"Warning: blob size %d >= minimum size %d\n",
+					totalsize, minsize);
+		}
+	}
+
+	if (padsize > 0)
+		padlen = padsize;
+
+	if (alignsize > 0)
+		padlen = ALIGN(totalsize + padlen, alignsize) - totalsize;
+
+	return padlen;
+}
+
+/*
+ * Writes out a blob that dt_from_blob() read for relayout only: packed by
+ * libfdt, then padded and given the boot cpu as dt_to_blob() would.
+ */
+static void relayout_blob(FILE *f, struct dt_info *dti)
+{
+	struct flat_writer *fw;
+	char *buf;
+	int bufsize, size, padlen, err;
+
+	/* Room for the blob, should its header grow to v17 */
+	bufsize = fdt_totalsize(dti->blob) + FDT_V17_SIZE;
+	buf = xmalloc(bufsize);
+
+	err = fdt_open_into(dti->blob, buf, bufsize);
+	if (!err)
+		err = fdt_pack(buf);
+	if (err)
+		die("Error relaying out device tree blob: %s\n",
+		    fdt_strerror(err));
+
+	size = fdt_totalsize(buf);
+	padlen = blob_padlen(size);
+
+	fdt_set_boot_cpuid_phys(buf, dti->boot_cpuid_phys);
+	fdt_set_totalsize(buf, size + padlen);
+
+	dti->blob_rsvmap_size = fdt_off_dt_struct(buf) - fdt_off_mem_rsvmap(buf);
+	dti->blob_struct_size = fdt_size_dt_struct(buf);
+	dti->blob_strings_size = fdt_size_dt_strings(buf);
+	dti->blob_totalsize = fdt_totalsize(buf);
+
+	fw = xmalloc(sizeof(*fw));
+	fw->f = f;
+	fw->len = fw->buflen = 0;
+
+	flat_write(fw, buf, size);
+	flat_write_zeroes(fw, padlen);
+	flat_flush(fw);
+
+	free(fw);
+	free(buf);
+}
+
 void dt_to_blob(FILE *f, struct dt_info *dti, int version)
 {
 	struct version_info *vi = NULL;
 	int i;
-	struct data blob       = empty_data;
 	struct data reservebuf = empty_data;
-	struct data dtbuf      = empty_data;
-	struct data strbuf     = empty_data;
+	struct data strbuf;
+	struct stringtable strtab;
 	struct fdt_header fdt;
+	struct flat_writer *fw;
 	int padlen = 0;
+	int dtsize;
 
 	for (i = 0; i < ARRAY_SIZE(version_table); i++) {
 		if (version_table[i].version == version)
@@ -375,73 +728,75 @@ void dt_to_blob(FILE *f, struct dt_info *dti, int version)
 	if (!vi)
 		die("Unknown device tree blob version %d\n", version);
 
-	flatten_tree(dti->dt, &bin_emitter, &dtbuf, &strbuf, vi);
-	bin_emit_cell(&dtbuf, FDT_END);
+	if (!dti->dt) {
+		assert(version == FDT_LAST_SUPPORTED_VERSION);
+		relayout_blob(f, dti);
+		return;
+	}
+
+	/* Size the structure block, without writing it yet */
+	fw = xmalloc(sizeof(*fw));
+	fw->f = NULL;
+	fw->len = fw->buflen = 0;
+
+	stringtable_init(&strtab, dti->dt, share_suffixes);
+	flatten_tree(dti->dt, &bin_emitter, fw, &strtab, vi);
+	bin_emit_cell(fw, FDT_END);
+	dtsize = fw->len;
 
 	reservebuf = flatten_reserve_list(dti->reservelist, vi);
 
 	/* Make header */
-	make_fdt_header(&fdt, vi, reservebuf.len, dtbuf.len, strbuf.len,
+	make_fdt_header(&fdt, vi, reservebuf.len, dtsize, strtab.data.len,
 			dti->boot_cpuid_phys);
 
 	/*
 	 * If the user asked for more space than is used, adjust the totalsize.
 	 */
-	if (minsize > 0) {
-		padlen = minsize - fdt32_to_cpu(fdt.totalsize);
-		if (padlen < 0) {
-			padlen = 0;
-			if (quiet < 1)
-				fprintf(stderr,
-					"Warning: blob size %d >= minimum size %d\n",
-					fdt32_to_cpu(fdt.totalsize), minsize);
-		}
-	}
-
-	if (padsize > 0)
-		padlen = padsize;
-
-	if (alignsize > 0)
-		padlen = ALIGN(fdt32_to_cpu(fdt.totalsize) + padlen, alignsize)
-			- fdt32_to_cpu(fdt.totalsize);
-
+	padlen = blob_padlen(fdt32_to_cpu(fdt.totalsize));
 	if (padlen > 0) {
 		int tsize = fdt32_to_cpu(fdt.totalsize);
 		tsize += padlen;
 		fdt.totalsize = cpu_to_fdt32(tsize);
 	}
 
+	dti->blob_rsvmap_size = reservebuf.len
+		+ sizeof(struct fdt_reserve_entry);
+	dti->blob_struct_size = dtsize;
+	dti->blob_strings_size = strtab.data.len;
+	dti->blob_totalsize = fdt32_to_cpu(fdt.totalsize);
+
 	/*
-	 * Assemble the blob: start with the header, add with alignment
-	 * the reserve buffer, add the reserve map terminating zeroes,
-	 * the device tree itself, and finally the strings.
+	 * Write the blob: start with the header, add with alignment the
+	 * reserve buffer and the reserve map terminating zeroes.
 	 */
-	blob = data_append_data(blob, &fdt, vi->hdr_size);
-	blob = data_append_align(blob, 8);
-	blob = data_merge(blob, reservebuf);
-	blob = data_append_zeroes(blob, sizeof(struct fdt_reserve_entry));
-	blob = data_merge(blob, dtbuf);
-	blob = data_merge(blob, strbuf);
+	fw->f = f;
+	fw->len = 0;
+	flat_write(fw, &fdt, vi->hdr_size);
+	bin_emit_align(fw, 8);
+	flat_write(fw, reservebuf.val, reservebuf.len);
+	flat_write_zeroes(fw, sizeof(struct fdt_reserve_entry));
+	data_free(reservebuf);
 
 	/*
-	 * If the user asked for more space than is used, pad out the blob.
+	 * Then the device tree itself, which finds all its names already
+	 * in the string table, and finally the strings.
 	 */
-	if (padlen > 0)
-		blob = data_append_zeroes(blob, padlen);
+	flatten_tree(dti->dt, &bin_emitter, fw, &strtab, vi);
+	bin_emit_cell(fw, FDT_END);
+	assert(fw->len == fdt32_to_cpu(fdt.off_dt_strings));
 
-	if (fwrite(blob.val, blob.len, 1, f) != 1) {
-		if (ferror(f))
-			die("Error writing device tree blob: %s\n",
-			    strerror(errno));
-		else
-			die("Short write on device tree blob\n");
-	}
+	strbuf = stringtable_finish(&strtab);
+	bin_emit_data(fw, strbuf);
+	data_free(strbuf);
 
 	/*
-	 * data_merge() frees the right-hand element so only the blob
-	 * remains to be freed.
+	 * If the user asked for more space than is used, pad out the blob.
 	 */
-	data_free(blob);
+	flat_write_zeroes(fw, padlen);
+	flat_flush(fw);
+
+	free(fw);
 }
 
 static void dump_stringtable_asm(FILE *f, struct data strbuf)
@@ -462,7 +817,8 @@ void dt_to_asm(FILE *f, struct dt_info *dti, int version)
 {
 	struct version_info *vi = NULL;
 	int i;
-	struct data strbuf = empty_data;
+	struct data strbuf;
+	struct stringtable strtab;
 	struct reserve_info *re;
 	const char *symprefix = "dt";
 
@@ -548,7 +904,9 @@ void dt_to_asm(FILE *f, struct dt_info *dti, int version)
 	fprintf(f, "\t.long\t0, 0\n\t.long\t0, 0\n");
 
 	emit_label(f, symprefix, "struct_start");
-	flatten_tree(dti->dt, &asm_emitter, f, &strbuf, vi);
+	stringtable_init(&strtab, dti->dt, share_suffixes);
+	flatten_tree(dti->dt, &asm_emitter, f, &strtab, vi);
+	strbuf = stringtable_finish(&strtab);
 
 	fprintf(f, "\t/* FDT_END */\n");
 	asm_emit_cell(f, FDT_END);
@@ -579,6 +937,7 @@ void dt_to_asm(FILE *f, struct dt_info *dti, int version)
 
 struct inbuf {
 	char *base, *limit, *ptr;
+	bool borrow;		/* values borrow from the buffer */
 };
 
 static void inbuf_init(struct inbuf *inb, void *base, void *limit)
@@ -586,6 +945,7 @@ static void inbuf_init(struct inbuf *inb, void *base, void *limit)
 	inb->base = base;
 	inb->limit = limit;
 	inb->ptr = inb->base;
+	inb->borrow = false;
 }
 
 static void flat_read_chunk(struct inbuf *inb, void *p, int len)
@@ -646,10 +1006,17 @@ static struct data flat_read_data(struct inbuf *inb, int len)
 	if (len == 0)
 		return empty_data;
 
-	d = data_grow_for(d, len);
-	d.len = len;
+	if (inb->borrow) {
+		if ((inb->ptr + len) > inb->limit)
+			die("Premature end of data parsing flat device tree\n");
+		d = data_borrow(inb->ptr, len);
+		inb->ptr += len;
+	} else {
+		d = data_grow_for(d, len);
+		d.len = len;
 
-	flat_read_chunk(inb, d.val, len);
+		flat_read_chunk(inb, d.val, len);
+	}
 
 	flat_realign(inb, sizeof(uint32_t));
 
@@ -807,7 +1174,36 @@ static struct node *unflatten_tree(struct inbuf *dtbuf,
 }
 
 
-struct dt_info *dt_from_blob(const char *fname)
+/*
+ * Maps the whole of the blob file f, if it can be, for property values
+ * to borrow from.  Like the tree, the mapping is kept until dtc exits,
+ * so it is not made if f is also the output file, outname, which will
+ * be truncated while the mapping is still in use.
+ */
+static char *map_blob(FILE *f, uint32_t totalsize, const char *outname)
+{
+	struct stat st, ost;
+	char *blob;
+
+	/* The blob has to start the file: only its header has been read */
+	if ((ftello(f) != 2 * sizeof(fdt32_t))
+	    || (fstat(fileno(f), &st) != 0) || !S_ISREG(st.st_mode)
+	    || (st.st_size < totalsize))
+		return NULL;
+
+	if (outname && !streq(outname, "-") && (stat(outname, &ost) == 0)
+	    && (st.st_dev == ost.st_dev) && (st.st_ino == ost.st_ino))
+		return NULL;
+
+	blob = mmap(NULL, totalsize, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (blob == MAP_FAILED)
+		return NULL;
+
+	return blob;
+}
+
+struct dt_info *dt_from_blob(const char *fname, const char *outname,
+			     bool relayout)
 {
 	FILE *f;
 	fdt32_t magic_buf, totalsize_buf;
@@ -822,8 +1218,10 @@ struct dt_info *dt_from_blob(const char *fname)
 	int sizeleft;
 	struct reserve_info *reservelist;
 	struct node *tree;
+	struct dt_info *dti;
 	uint32_t val;
 	int flags = 0;
+	bool borrow;
 
 	f = srcfile_relative_open(fname, NULL);
 
@@ -856,14 +1254,22 @@ struct dt_info *dt_from_blob(const char *fname)
 	if (totalsize < FDT_V1_SIZE)
 		die("DT blob size (%d) is too small\n", totalsize);
 
-	blob = xmalloc(totalsize);
+	blob = map_blob(f, totalsize, outname);
+	borrow = (blob != NULL);
+
+	if (borrow) {
+		fdt = (struct fdt_header *)blob;
+		sizeleft = 0;
+	} else {
+		blob = xmalloc(totalsize);
 
-	fdt = (struct fdt_header *)blob;
-	fdt->magic = cpu_to_fdt32(magic);
-	fdt->totalsize = cpu_to_fdt32(totalsize);
+		fdt = (struct fdt_header *)blob;
+		fdt->magic = cpu_to_fdt32(magic);
+		fdt->totalsize = cpu_to_fdt32(totalsize);
 
-	sizeleft = totalsize - sizeof(magic) - sizeof(totalsize);
-	p = blob + sizeof(magic)  + sizeof(totalsize);
+		sizeleft = totalsize - sizeof(magic) - sizeof(totalsize);
+		p = blob + sizeof(magic)  + sizeof(totalsize);
+	}
 
 	while (sizeleft) {
 		if (feof(f))
@@ -915,9 +1321,26 @@ struct dt_info *dt_from_blob(const char *fname)
 		flags |= FTF_NOPS;
 	}
 
+	/*
+	 * A blob only being relaid out isn't unflattened: dt_to_blob()
+	 * writes it out from here.
+	 */
+	if (relayout && (version >= 16)) {
+		rc = fdt_check_header(blob);
+		if (rc)
+			die("Bad device tree blob: %s\n", fdt_strerror(rc));
+
+		fclose(f);
+
+		dti = build_dt_info(DTSF_V1, NULL, NULL, boot_cpuid_phys);
+		dti->blob = blob;
+		return dti;
+	}
+
 	inbuf_init(&memresvbuf,
 		   blob + off_mem_rsvmap, blob + totalsize);
 	inbuf_init(&dtbuf, blob + off_dt, blob + totalsize);
+	dtbuf.borrow = borrow;
 
 	reservelist = flat_read_mem_reserve(&memresvbuf);
 
@@ -932,7 +1355,8 @@ struct dt_info *dt_from_blob(const char *fname)
 	if (val != FDT_END)
 		die("Device tree blob doesn't end with FDT_END\n");
 
-	free(blob);
+	if (!borrow)
+		free(blob);
 
 	fclose(f);
 
@@ -55,6 +55,8 @@
 
 #include "libfdt_internal.h"
 
+uint32_t _fdt_generation;
+
 int fdt_check_header(const void *fdt)
 {
 	if (fdt_magic(fdt) == FDT_MAGIC) {
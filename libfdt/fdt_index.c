@@ -0,0 +1,634 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *
+ * libfdt is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This library is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This library is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "libfdt_env.h"
+
+#include <fdt.h>
+#include <libfdt.h>
+
+#include "libfdt_internal.h"
+
+void fdt_index_invalidate(void *index)
+{
+	struct _fdt_index_tag *tag = index;
+
+	if (tag)
+		tag->fdt = NULL;
+}
+
+static int _fdt_phandle_entry_cmp(const void *fdt, const void *a,
+				  const void *b)
+{
+	const struct _fdt_phandle_entry *pa = a, *pb = b;
+
+	if (pa->phandle != pb->phandle)
+		return (pa->phandle < pb->phandle) ? -1 : 1;
+	return pa->offset - pb->offset;
+}
+
+static void _fdt_swap(char *a, char *b, int size)
+{
+	char tmp;
+
+	while (size--) {
+		tmp = *a;
+		*a++ = *b;
+		*b++ = tmp;
+	}
+}
+
+/* In-place heapsort: no recursion and no allocation, bootloader safe */
+static void _fdt_sift_down(char *e, int size, int root, int n,
+			   int (*cmp)(const void *, const void *, const void *),
+			   const void *fdt)
+{
+	int child;
+
+	while ((child = 2 * root + 1) < n) {
+		if ((child + 1 < n)
+		    && (cmp(fdt, e + child * size, e + (child + 1) * size) < 0))
+			child++;
+		if (cmp(fdt, e + root * size, e + child * size) >= 0)
+			return;
+		_fdt_swap(e + root * size, e + child * size, size);
+		root = child;
+	}
+}
+
+void _fdt_sort(void *entries, int size, int n,
+	       int (*cmp)(const void *, const void *, const void *),
+	       const void *fdt)
+{
+	char *e = entries;
+	int i;
+
+	for (i = n / 2 - 1; i >= 0; i--)
+		_fdt_sift_down(e, size, i, n, cmp, fdt);
+	for (i = n - 1; i > 0; i--) {
+		_fdt_swap(e, e + i * size, size);
+		_fdt_sift_down(e, size, 0, i, cmp, fdt);
+	}
+}
+
+/*
+ * Walk the structure block once, recording the phandle of every node
+ * which has one.  Entries are only stored while they fit in @max, but
+ * the full count is always returned, so this doubles as the sizing
+ * pass.  The choice between "phandle" and "linux,phandle" follows
+ * fdt_get_phandle().
+ */
+static int _fdt_scan_phandles(const void *fdt,
+			      struct _fdt_phandle_entry *entries, int max)
+{
+	struct _fdt_phandle_names pn;
+	const struct fdt_property *prop;
+	int offset, nextoffset = 0;
+	int node = -1, depth = 0, count = 0;
+	uint32_t phandle = 0, lphandle = 0;
+	uint32_t tag, val;
+
+	_fdt_phandle_names_init(&pn, fdt);
+
+	do {
+		offset = nextoffset;
+		tag = fdt_next_tag(fdt, offset, &nextoffset);
+
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+		case FDT_END_NODE:
+		case FDT_END:
+			if (node >= 0) {
+				val = phandle ? phandle : lphandle;
+				if ((val != 0) && (val != (uint32_t)-1)) {
+					if (count < max) {
+						entries[count].phandle = val;
+						entries[count].offset = node;
+					}
+					count++;
+				}
+			}
+			if (tag == FDT_BEGIN_NODE) {
+				node = offset;
+				depth++;
+			} else {
+				node = -1;
+				if (tag == FDT_END_NODE)
+					depth--;
+			}
+			phandle = lphandle = 0;
+			break;
+
+		case FDT_PROP:
+			if (node < 0)
+				return -FDT_ERR_BADSTRUCTURE;
+			prop = _fdt_offset_ptr(fdt, offset);
+			if (fdt32_to_cpu(prop->len) != sizeof(fdt32_t))
+				break;
+			val = fdt32_to_cpu(*(const fdt32_t *)prop->data);
+			switch (_fdt_phandle_prop_kind(&pn,
+					fdt32_to_cpu(prop->nameoff))) {
+			case FDT_PHANDLE_PROP:
+				if (!phandle)
+					phandle = val ? val : (uint32_t)-1;
+				break;
+			case FDT_LINUX_PHANDLE_PROP:
+				if (!lphandle)
+					lphandle = val ? val : (uint32_t)-1;
+				break;
+			}
+			break;
+		}
+	} while (tag != FDT_END);
+
+	/* As in fdt_next_node(), a truncated tree is fine provided we
+	 * ran out between top-level nodes (unfinished sequential-write
+	 * trees end like this) */
+	if ((nextoffset < 0)
+	    && ((nextoffset != -FDT_ERR_TRUNCATED) || depth))
+		return nextoffset;
+
+	return count;
+}
+
+int fdt_index_size(const void *fdt)
+{
+	int count;
+
+	FDT_CHECK_HEADER(fdt);
+
+	count = _fdt_scan_phandles(fdt, NULL, 0);
+	if (count < 0)
+		return count;
+
+	return sizeof(struct _fdt_index)
+		+ count * sizeof(struct _fdt_phandle_entry);
+}
+
+int fdt_index_build(const void *fdt, void *buf, int bufsize)
+{
+	struct _fdt_index *idx = buf;
+	int max, count;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (bufsize < (int)sizeof(*idx))
+		return -FDT_ERR_NOSPACE;
+
+	/* Leave the index unusable unless we complete */
+	idx->tag.fdt = NULL;
+
+	max = (bufsize - sizeof(*idx)) / sizeof(idx->phandles[0]);
+	count = _fdt_scan_phandles(fdt, idx->phandles, max);
+	if (count < 0)
+		return count;
+	if (count > max)
+		return -FDT_ERR_NOSPACE;
+
+	_fdt_sort(idx->phandles, sizeof(idx->phandles[0]), count,
+		  _fdt_phandle_entry_cmp, fdt);
+
+	idx->nphandles = count;
+	_fdt_index_tag_set(&idx->tag, fdt);
+
+	return 0;
+}
+
+int fdt_node_offset_by_phandle_idx(const void *fdt, const void *index,
+				   uint32_t phandle)
+{
+	const struct _fdt_index *idx = index;
+	int lo, hi, mid;
+
+	if ((phandle == 0) || (phandle == -1))
+		return -FDT_ERR_BADPHANDLE;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (!idx || !_fdt_index_tag_valid(&idx->tag, fdt))
+		return fdt_node_offset_by_phandle(fdt, phandle);
+
+	/* Find the first entry, i.e. the earliest node in the tree,
+	 * carrying this phandle */
+	lo = 0;
+	hi = idx->nphandles;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (idx->phandles[mid].phandle < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if ((lo >= idx->nphandles) || (idx->phandles[lo].phandle != phandle))
+		return -FDT_ERR_NOTFOUND;
+
+	/* A node changed in place may no longer carry the phandle */
+	if (fdt_get_phandle(fdt, idx->phandles[lo].offset) != phandle)
+		return fdt_node_offset_by_phandle(fdt, phandle);
+
+	return idx->phandles[lo].offset;
+}
+
+/*
+ * Symbol entries are sorted by label, then by property offset so that
+ * the first of any duplicate labels wins, as with fdt_getprop().
+ */
+static int _fdt_symbol_entry_cmp(const void *fdt, const void *a,
+				 const void *b)
+{
+	const struct _fdt_symbol_entry *sa = a, *sb = b;
+	int ret;
+
+	ret = strcmp(fdt_string(fdt, sa->nameoff),
+		     fdt_string(fdt, sb->nameoff));
+	if (ret)
+		return ret;
+	return sa->prop - sb->prop;
+}
+
+/*
+ * Record every property of /__symbols__, while they fit in @max.  The
+ * full count is always returned, so this doubles as the sizing pass.
+ */
+static int _fdt_scan_symbols(const void *fdt,
+			     struct _fdt_symbol_entry *entries, int max)
+{
+	const struct fdt_property *prop;
+	int symbols, property, len;
+	int count = 0;
+
+	symbols = fdt_path_offset(fdt, "/__symbols__");
+	if (symbols == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (symbols < 0)
+		return symbols;
+
+	fdt_for_each_property_offset(property, fdt, symbols) {
+		prop = fdt_get_property_by_offset(fdt, property, &len);
+		if (!prop)
+			return len;
+
+		if (count < max) {
+			entries[count].nameoff = fdt32_to_cpu(prop->nameoff);
+			entries[count].prop = property;
+			entries[count].offset = 0;
+		}
+		count++;
+	}
+	if ((property < 0) && (property != -FDT_ERR_NOTFOUND))
+		return property;
+
+	return count;
+}
+
+int fdt_symbol_index_size(const void *fdt)
+{
+	int count;
+
+	FDT_CHECK_HEADER(fdt);
+
+	count = _fdt_scan_symbols(fdt, NULL, 0);
+	if (count < 0)
+		return count;
+
+	return sizeof(struct _fdt_symbol_index)
+		+ count * sizeof(struct _fdt_symbol_entry);
+}
+
+int fdt_symbol_index_build(const void *fdt, void *buf, int bufsize)
+{
+	struct _fdt_symbol_index *idx = buf;
+	int max, count;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (bufsize < (int)sizeof(*idx))
+		return -FDT_ERR_NOSPACE;
+
+	/* Leave the index unusable unless we complete */
+	idx->tag.fdt = NULL;
+
+	max = (bufsize - sizeof(*idx)) / sizeof(idx->symbols[0]);
+	count = _fdt_scan_symbols(fdt, idx->symbols, max);
+	if (count < 0)
+		return count;
+	if (count > max)
+		return -FDT_ERR_NOSPACE;
+
+	_fdt_sort(idx->symbols, sizeof(idx->symbols[0]), count,
+		  _fdt_symbol_entry_cmp, fdt);
+
+	idx->nsymbols = count;
+	idx->paths = NULL;
+	_fdt_index_tag_set(&idx->tag, fdt);
+
+	return 0;
+}
+
+static int _fdt_symbol_offset_idx(const void *fdt, void *index,
+				  const char *name)
+{
+	struct _fdt_symbol_index *idx = index;
+	struct _fdt_symbol_entry *e;
+	const char *path;
+	int lo, hi, mid, len;
+
+	lo = 0;
+	hi = idx->nsymbols;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strcmp(fdt_string(fdt, idx->symbols[mid].nameoff),
+			   name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if ((lo == idx->nsymbols)
+	    || strcmp(fdt_string(fdt, idx->symbols[lo].nameoff), name))
+		return -FDT_ERR_NOTFOUND;
+
+	/* Paths are only resolved, once, when first looked up */
+	e = &idx->symbols[lo];
+	if (e->prop >= 0) {
+		path = fdt_getprop_by_offset(fdt, e->prop, NULL, &len);
+		e->offset = path
+			? fdt_path_offset_cached(fdt, idx->paths, path) : len;
+		e->prop = -1;
+	}
+
+	return e->offset;
+}
+
+int fdt_node_offset_by_symbol_idx(const void *fdt, void *index,
+				  const char *name)
+{
+	const struct _fdt_symbol_index *idx = index;
+	const char *path;
+	int symbols, len;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (idx && _fdt_index_tag_valid(&idx->tag, fdt))
+		return _fdt_symbol_offset_idx(fdt, index, name);
+
+	symbols = fdt_path_offset(fdt, "/__symbols__");
+	if (symbols < 0)
+		return symbols;
+
+	path = fdt_getprop(fdt, symbols, name, &len);
+	if (!path)
+		return len;
+
+	return fdt_path_offset(fdt, path);
+}
+
+/*
+ * Walk the tree once, recording every node with the ordinal of its
+ * parent and its depth, in tree (and so offset) order.  Entries are
+ * only stored while they fit in @max, but the full count is always
+ * returned, so this doubles as the sizing pass.
+ */
+static int _fdt_scan_nodes(const void *fdt, struct _fdt_node_entry *entries,
+			   int max)
+{
+	int offset, depth, parent, prevdepth = -1;
+	int count = 0;
+
+	for (offset = 0, depth = 0;
+	     (offset >= 0) && (depth >= 0);
+	     offset = fdt_next_node(fdt, offset, &depth)) {
+		if (count < max) {
+			/* The parent is the last node seen one level up */
+			parent = count - 1;
+			while (prevdepth-- >= depth)
+				parent = entries[parent].parent;
+
+			entries[count].offset = offset;
+			entries[count].parent = parent;
+			entries[count].depth = depth;
+		}
+		prevdepth = depth;
+		count++;
+	}
+
+	if ((offset < 0) && (offset != -FDT_ERR_NOTFOUND))
+		return offset;
+
+	return count;
+}
+
+static int _fdt_node_index_valid(const void *fdt,
+				 const struct _fdt_node_index *idx)
+{
+	return idx && _fdt_index_tag_valid(&idx->tag, fdt);
+}
+
+/* Ordinal of the node at @nodeoffset, or -1 if there is none */
+static int _fdt_node_index_find(const struct _fdt_node_index *idx,
+				int nodeoffset)
+{
+	int lo, hi, mid;
+
+	lo = 0;
+	hi = idx->nnodes;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (idx->nodes[mid].offset < nodeoffset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if ((lo < idx->nnodes) && (idx->nodes[lo].offset == nodeoffset))
+		return lo;
+
+	return -1;
+}
+
+int fdt_node_index_size(const void *fdt)
+{
+	int count;
+
+	FDT_CHECK_HEADER(fdt);
+
+	count = _fdt_scan_nodes(fdt, NULL, 0);
+	if (count < 0)
+		return count;
+
+	return sizeof(struct _fdt_node_index)
+		+ count * sizeof(struct _fdt_node_entry);
+}
+
+int fdt_node_index_build(const void *fdt, void *buf, int bufsize)
+{
+	struct _fdt_node_index *idx = buf;
+	int max, count;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (bufsize < (int)sizeof(*idx))
+		return -FDT_ERR_NOSPACE;
+
+	/* Leave the index unusable unless we complete */
+	idx->tag.fdt = NULL;
+
+	max = (bufsize - sizeof(*idx)) / sizeof(idx->nodes[0]);
+	count = _fdt_scan_nodes(fdt, idx->nodes, max);
+	if (count < 0)
+		return count;
+	if (count > max)
+		return -FDT_ERR_NOSPACE;
+
+	idx->nnodes = count;
+	_fdt_index_tag_set(&idx->tag, fdt);
+
+	return 0;
+}
+
+int fdt_get_path_idx(const void *fdt, const void *index, int nodeoffset,
+		     char *buf, int buflen)
+{
+	const struct _fdt_node_index *idx = index;
+	const char *name;
+	int i, p, namelen;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (buflen < 2)
+		return -FDT_ERR_NOSPACE;
+
+	if (!_fdt_node_index_valid(fdt, idx)
+	    || ((i = _fdt_node_index_find(idx, nodeoffset)) < 0))
+		return fdt_get_path(fdt, nodeoffset, buf, buflen);
+
+	/* Measure the path, then fill it in from the end */
+	for (p = 0; idx->nodes[i].depth > 0; i = idx->nodes[i].parent) {
+		name = fdt_get_name(fdt, idx->nodes[i].offset, &namelen);
+		if (!name)
+			return namelen;
+		p += namelen + 1;
+	}
+	if ((p + 1) > buflen)
+		return -FDT_ERR_NOSPACE;
+
+	/* special case so that root path is "/", not "" */
+	if (!p)
+		p = 1;
+	buf[p] = '\0';
+	buf[0] = '/';
+	for (i = _fdt_node_index_find(idx, nodeoffset);
+	     idx->nodes[i].depth > 0;
+	     i = idx->nodes[i].parent) {
+		name = fdt_get_name(fdt, idx->nodes[i].offset, &namelen);
+		p -= namelen;
+		memcpy(buf + p, name, namelen);
+		buf[--p] = '/';
+	}
+
+	return 0;
+}
+
+int fdt_supernode_atdepth_offset_idx(const void *fdt, const void *index,
+				     int nodeoffset, int supernodedepth,
+				     int *nodedepth)
+{
+	const struct _fdt_node_index *idx = index;
+	int i;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (supernodedepth < 0)
+		return -FDT_ERR_NOTFOUND;
+
+	if (!_fdt_node_index_valid(fdt, idx)
+	    || ((i = _fdt_node_index_find(idx, nodeoffset)) < 0))
+		return fdt_supernode_atdepth_offset(fdt, nodeoffset,
+						    supernodedepth, nodedepth);
+
+	if (nodedepth)
+		*nodedepth = idx->nodes[i].depth;
+
+	if (supernodedepth > idx->nodes[i].depth)
+		return -FDT_ERR_NOTFOUND;
+
+	while (idx->nodes[i].depth > supernodedepth)
+		i = idx->nodes[i].parent;
+
+	return idx->nodes[i].offset;
+}
+
+int fdt_node_depth_idx(const void *fdt, const void *index, int nodeoffset)
+{
+	int nodedepth;
+	int err;
+
+	err = fdt_supernode_atdepth_offset_idx(fdt, index, nodeoffset, 0,
+					       &nodedepth);
+	if (err)
+		return (err < 0) ? err : -FDT_ERR_INTERNAL;
+	return nodedepth;
+}
+
+int fdt_parent_offset_idx(const void *fdt, const void *index, int nodeoffset)
+{
+	const struct _fdt_node_index *idx = index;
+	int i;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (!_fdt_node_index_valid(fdt, idx)
+	    || ((i = _fdt_node_index_find(idx, nodeoffset)) < 0))
+		return fdt_parent_offset(fdt, nodeoffset);
+
+	if (idx->nodes[i].parent < 0)
+		return -FDT_ERR_NOTFOUND;
+
+	return idx->nodes[idx->nodes[i].parent].offset;
+}
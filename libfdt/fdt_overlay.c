@@ -39,6 +39,7 @@ static uint32_t overlay_get_target_phandle(const void *fdto, int fragment)
  * @fdt: Base device tree blob
  * @fdto: Device tree overlay blob
  * @fragment: node offset of the fragment in the overlay
+ * @phandles: phandle index of the base device tree, or NULL
  *
  * overlay_get_target() retrieves the target offset in the base
  * device tree of a fragment, no matter how the actual targetting is
@@ -49,7 +50,7 @@ static uint32_t overlay_get_target_phandle(const void *fdto, int fragment)
  *      Negative error code on error
  */
 static int overlay_get_target(const void *fdt, const void *fdto,
-			      int fragment)
+			      int fragment, const void *phandles)
 {
 	uint32_t phandle;
 	const char *path;
@@ -61,7 +62,7 @@ static int overlay_get_target(const void *fdt, const void *fdto,
 		return -FDT_ERR_BADPHANDLE;
 
 	if (phandle)
-		return fdt_node_offset_by_phandle(fdt, phandle);
+		return fdt_node_offset_by_phandle_idx(fdt, phandles, phandle);
 
 	/* And then a path based lookup */
 	path = fdt_getprop(fdto, fragment, "target-path", &path_len);
@@ -324,11 +325,85 @@ static int overlay_update_local_references(void *fdto, uint32_t delta)
 						    delta);
 }
 
+/**
+ * overlay_free_space - Find the unused room at the end of a tree's buffer
+ * @fdt: Base Device Tree blob
+ * @freep: set to the start of the free space
+ *
+ * Only trees in the usual layout, with the strings block last, are
+ * considered to have any.  The free space is aligned for any of the
+ * scratch structures kept there.
+ *
+ * returns:
+ *      the size of the free space in bytes (> 0), on success
+ *      -FDT_ERR_NOSPACE, if there is none
+ */
+static int overlay_free_space(void *fdt, char **freep)
+{
+	int used;
+
+	if ((fdt_magic(fdt) != FDT_MAGIC) || (fdt_version(fdt) < 17)
+	    || (fdt_off_dt_strings(fdt)
+		< (fdt_off_dt_struct(fdt) + fdt_size_dt_struct(fdt))))
+		return -FDT_ERR_NOSPACE;
+
+	used = FDT_ALIGN(fdt_off_dt_strings(fdt) + fdt_size_dt_strings(fdt),
+			 sizeof(uint64_t));
+	if (used >= fdt_totalsize(fdt))
+		return -FDT_ERR_NOSPACE;
+
+	*freep = (char *)fdt + used;
+	return fdt_totalsize(fdt) - used;
+}
+
+#define OVERLAY_PATH_CACHE_SIZE	16384
+
+/**
+ * overlay_symbol_index - Index the base tree's labels for fixups
+ * @fdt: Base Device Tree blob
+ *
+ * overlay_symbol_index() builds an index of the base tree's
+ * __symbols__ in the free space at the end of its buffer, so that
+ * resolving the fixups of one or more overlays against the tree, as
+ * it stands, does not rescan __symbols__ and the tree for each one.
+ * The index, and the path cache it resolves labels through, are good
+ * until the base tree is next modified.
+ *
+ * returns:
+ *      the index, or NULL if it does not fit
+ */
+static void *overlay_symbol_index(void *fdt)
+{
+	struct _fdt_symbol_index *idx;
+	char *freep;
+	int freesize, idxsize, cachesize;
+
+	freesize = overlay_free_space(fdt, &freep);
+	if (freesize < 0)
+		return NULL;
+
+	if (fdt_symbol_index_build(fdt, freep, freesize))
+		return NULL;
+	idx = (struct _fdt_symbol_index *)freep;
+
+	/* Labels mostly share path prefixes, cache them if there's room */
+	idxsize = sizeof(*idx) + idx->nsymbols * sizeof(idx->symbols[0]);
+	idxsize = FDT_ALIGN(idxsize, sizeof(uint64_t));
+	cachesize = freesize - idxsize;
+	if (cachesize > OVERLAY_PATH_CACHE_SIZE)
+		cachesize = OVERLAY_PATH_CACHE_SIZE;
+	if (!fdt_path_cache_init(fdt, freep + idxsize, cachesize))
+		idx->paths = (struct _fdt_path_cache *)(freep + idxsize);
+
+	return idx;
+}
+
 /**
  * overlay_fixup_one_phandle - Set an overlay phandle to the base one
  * @fdt: Base Device Tree blob
  * @fdto: Device tree overlay blob
  * @symbols_off: Node offset of the symbols node in the base device tree
+ * @symbols: symbol index of the base device tree, or NULL
  * @path: Path to a node holding a phandle in the overlay
  * @path_len: number of path characters to consider
  * @name: Name of the property holding the phandle reference in the overlay
@@ -348,7 +423,7 @@ static int overlay_update_local_references(void *fdto, uint32_t delta)
  *      Negative error code on failure
  */
 static int overlay_fixup_one_phandle(void *fdt, void *fdto,
-				     int symbols_off,
+				     int symbols_off, void *symbols,
 				     const char *path, uint32_t path_len,
 				     const char *name, uint32_t name_len,
 				     int poffset, const char *label)
@@ -359,15 +434,20 @@ static int overlay_fixup_one_phandle(void *fdt, void *fdto,
 	int symbol_off, fixup_off;
 	int prop_len;
 
-	if (symbols_off < 0)
-		return symbols_off;
+	if (symbols) {
+		symbol_off = fdt_node_offset_by_symbol_idx(fdt, symbols,
+							   label);
+	} else {
+		if (symbols_off < 0)
+			return symbols_off;
 
-	symbol_path = fdt_getprop(fdt, symbols_off, label,
-				  &prop_len);
-	if (!symbol_path)
-		return prop_len;
+		symbol_path = fdt_getprop(fdt, symbols_off, label,
+					  &prop_len);
+		if (!symbol_path)
+			return prop_len;
 
-	symbol_off = fdt_path_offset(fdt, symbol_path);
+		symbol_off = fdt_path_offset(fdt, symbol_path);
+	}
 	if (symbol_off < 0)
 		return symbol_off;
 
@@ -393,6 +473,7 @@ static int overlay_fixup_one_phandle(void *fdt, void *fdto,
  * @fdt: Base Device Tree blob
  * @fdto: Device tree overlay blob
  * @symbols_off: Node offset of the symbols node in the base device tree
+ * @symbols: symbol index of the base device tree, or NULL
  * @property: Property offset in the overlay holding the list of fixups
  *
  * overlay_fixup_phandle() resolves all the overlay phandles pointed
@@ -408,7 +489,7 @@ static int overlay_fixup_one_phandle(void *fdt, void *fdto,
  *      Negative error code on failure
  */
 static int overlay_fixup_phandle(void *fdt, void *fdto, int symbols_off,
-				 int property)
+				 void *symbols, int property)
 {
 	const char *value;
 	const char *label;
@@ -463,8 +544,8 @@ static int overlay_fixup_phandle(void *fdt, void *fdto, int symbols_off,
 			return -FDT_ERR_BADOVERLAY;
 
 		ret = overlay_fixup_one_phandle(fdt, fdto, symbols_off,
-						path, path_len, name, name_len,
-						poffset, label);
+						symbols, path, path_len,
+						name, name_len, poffset, label);
 		if (ret)
 			return ret;
 	} while (len > 0);
@@ -477,6 +558,7 @@ static int overlay_fixup_phandle(void *fdt, void *fdto, int symbols_off,
  *                          device tree
  * @fdt: Base Device Tree blob
  * @fdto: Device tree overlay blob
+ * @symbols: symbol index of the base device tree, or NULL
  *
  * overlay_fixup_phandles() resolves all the overlay phandles pointing
  * to nodes in the base device tree.
@@ -489,9 +571,9 @@ static int overlay_fixup_phandle(void *fdt, void *fdto, int symbols_off,
  *      0 on success
  *      Negative error code on failure
  */
-static int overlay_fixup_phandles(void *fdt, void *fdto)
+static int overlay_fixup_phandles(void *fdt, void *fdto, void *symbols)
 {
-	int fixups_off, symbols_off;
+	int fixups_off, symbols_off = -FDT_ERR_NOTFOUND;
 	int property;
 
 	/* We can have overlays without any fixups */
@@ -502,14 +584,17 @@ static int overlay_fixup_phandles(void *fdt, void *fdto)
 		return fixups_off;
 
 	/* And base DTs without symbols */
-	symbols_off = fdt_path_offset(fdt, "/__symbols__");
-	if ((symbols_off < 0 && (symbols_off != -FDT_ERR_NOTFOUND)))
-		return symbols_off;
+	if (!symbols) {
+		symbols_off = fdt_path_offset(fdt, "/__symbols__");
+		if ((symbols_off < 0 && (symbols_off != -FDT_ERR_NOTFOUND)))
+			return symbols_off;
+	}
 
 	fdt_for_each_property_offset(property, fdto, fixups_off) {
 		int ret;
 
-		ret = overlay_fixup_phandle(fdt, fdto, symbols_off, property);
+		ret = overlay_fixup_phandle(fdt, fdto, symbols_off, symbols,
+					    property);
 		if (ret)
 			return ret;
 	}
@@ -618,7 +703,7 @@ static int overlay_merge(void *fdt, void *fdto)
 		if (overlay < 0)
 			return overlay;
 
-		target = overlay_get_target(fdt, fdto, fragment);
+		target = overlay_get_target(fdt, fdto, fragment, NULL);
 		if (target < 0)
 			return target;
 
@@ -630,48 +715,1382 @@ static int overlay_merge(void *fdt, void *fdto)
 	return 0;
 }
 
-int fdt_overlay_apply(void *fdt, void *fdto)
+/*
+ * Rebuilding merge
+ *
+ * overlay_merge() splices every property and node into the base tree
+ * in place, and each splice memmove()s the rest of the blob.  The
+ * functions below instead stream the base tree and the contents of
+ * any number of overlays into a fresh tree with the sequential write
+ * functions, in a single ordered walk of the base.  The resulting
+ * tree is the one overlay_merge() would produce, down to the order of
+ * properties and subnodes: the read-write functions add new ones in
+ * front of the existing ones, so they come out most recent first.
+ *
+ * libfdt does not allocate memory, so the new tree, and the small
+ * amount of workspace the merge needs, go in the free space at the
+ * end of the base tree's buffer.  If there is not enough of it, the
+ * caller falls back to overlay_merge().
+ */
+
+/* An overlay node or property taking part in a rebuilding merge */
+struct overlay_item {
+	const void *fdto;	/* overlay blob */
+	int offset;		/* node or property offset in the overlay */
+	int seq;		/* application order of the owning fragment */
+	int slot;		/* node it merges into, see below */
+};
+
+/*
+ * overlay_item.slot is the offset of a base node (>= 0), or one of
+ * these for nodes which are not in the base tree
+ */
+#define OVERLAY_SLOT_NONE	(-1)
+#define OVERLAY_SLOT_NEW(n)	(-2 - (n))
+
+struct overlay_rebuild {
+	const void *fdt;		/* base device tree */
+	void *out;			/* device tree being written */
+	int strbase;			/* output offset of the base strings */
+	const void *phandles;		/* phandle index of the base */
+	struct overlay_item *frags;	/* fragments, by target then seq */
+	int nfrags;
+	int nextfrag;			/* first fragment not merged yet */
+	char *ws;			/* workspace */
+	int wssize;
+	int wsused;
+};
+
+static void *overlay_ws_alloc(struct overlay_rebuild *rb, int len)
 {
-	uint32_t delta = fdt_get_max_phandle(fdt);
-	int ret;
+	void *p;
 
-	FDT_CHECK_HEADER(fdt);
-	FDT_CHECK_HEADER(fdto);
+	len = FDT_ALIGN(len, sizeof(void *));
+	if (len > (rb->wssize - rb->wsused))
+		return NULL;
 
-	ret = overlay_adjust_local_phandles(fdto, delta);
-	if (ret)
-		goto err;
+	p = rb->ws + rb->wsused;
+	rb->wsused += len;
+	return p;
+}
 
-	ret = overlay_update_local_references(fdto, delta);
-	if (ret)
-		goto err;
+/* Node name matching, as done by fdt_subnode_offset() */
+static int overlay_nodename_eq(const char *p, int plen,
+			       const char *s, int len)
+{
+	if ((plen < len) || (memcmp(p, s, len) != 0))
+		return 0;
 
-	ret = overlay_fixup_phandles(fdt, fdto);
-	if (ret)
-		goto err;
+	if (plen == len)
+		return 1;
+
+	return !memchr(s, '@', len) && (p[len] == '@');
+}
+
+static int overlay_item_nodename_eq(const struct overlay_item *a,
+				    const struct overlay_item *b)
+{
+	const char *aname, *bname;
+	int alen, blen;
+
+	aname = fdt_get_name(a->fdto, a->offset, &alen);
+	bname = fdt_get_name(b->fdto, b->offset, &blen);
+	if (!aname || !bname)
+		return 0;
+
+	return overlay_nodename_eq(aname, alen, bname, blen);
+}
+
+/*
+ * The distinct property names set on a merged node, sorted by name, so
+ * that each base property, and each overlay property, finds the value
+ * it ends up with by a binary search
+ */
+struct overlay_propname {
+	const char *name;
+	int first;		/* first overlay property setting it */
+	int last;		/* last one, whose value it ends up with */
+	int in_base;		/* whether the base node has it */
+};
 
-	ret = overlay_merge(fdt, fdto);
+static int overlay_cmp_propnames(const void *fdt, const void *a,
+				 const void *b)
+{
+	const struct overlay_propname *pa = a, *pb = b;
+	int ret;
+
+	ret = strcmp(pa->name, pb->name);
 	if (ret)
-		goto err;
+		return ret;
+	return pa->first - pb->first;
+}
 
-	/*
-	 * The overlay has been damaged, erase its magic.
-	 */
-	fdt_set_magic(fdto, ~0);
+static struct overlay_propname *
+overlay_find_propname(struct overlay_propname *names, int n, const char *name)
+{
+	int lo = 0, hi = n, mid, ret;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		ret = strcmp(names[mid].name, name);
+		if (ret == 0)
+			return &names[mid];
+		if (ret < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return NULL;
+}
+
+/**
+ * overlay_emit_prop - Writes one property of the merged tree
+ * @rb: rebuild state
+ * @base_prop: offset of the base property of that name, or -1
+ * @name: property name
+ * @val: property value
+ * @len: property length
+ *
+ * Properties which exist in the base tree reuse its copy of their
+ * name, saving a search of the strings block.
+ *
+ * returns:
+ *      0 on success
+ *      Negative error code on failure
+ */
+static int overlay_emit_prop(struct overlay_rebuild *rb, int base_prop,
+			     const char *name, const void *val, int len)
+{
+	const struct fdt_property *prop;
+	void *p;
+	int ret;
+
+	if (base_prop >= 0) {
+		prop = fdt_get_property_by_offset(rb->fdt, base_prop, NULL);
+		if (!prop)
+			return -FDT_ERR_INTERNAL;
+
+		ret = _fdt_sw_property_nameoff(rb->out, rb->strbase
+					       + fdt32_to_cpu(prop->nameoff),
+					       len, &p);
+	} else {
+		ret = fdt_property_placeholder(rb->out, name, len, &p);
+	}
+	if (ret)
+		return ret;
 
+	memcpy(p, val, len);
 	return 0;
+}
+
+/**
+ * overlay_emit_props - Writes the properties of a merged node
+ * @rb: rebuild state
+ * @node: offset of the node in the base tree, or -1 for a new node
+ * @src: overlay nodes merged into it, in application order
+ * @nsrc: number of overlay nodes
+ *
+ * With b properties in the base node and o in the overlay nodes, this
+ * takes O((b + o) log o) string comparisons.
+ *
+ * returns:
+ *      0 on success
+ *      Negative error code on failure
+ */
+static int overlay_emit_props(struct overlay_rebuild *rb, int node,
+			      const struct overlay_item *src, int nsrc)
+{
+	struct overlay_item *props;
+	struct overlay_propname *names, *pn;
+	const char *name, *pname;
+	const void *val;
+	int count, nnames, mark, prop, len;
+	int i;
+	int ret = 0;
+
+	mark = rb->wsused;
+
+	/* The overlay properties, in the order they would be set */
+	count = 0;
+	for (i = 0; i < nsrc; i++)
+		fdt_for_each_property_offset(prop, src[i].fdto, src[i].offset)
+			count++;
+
+	props = overlay_ws_alloc(rb, count * sizeof(*props));
+	names = overlay_ws_alloc(rb, count * sizeof(*names));
+	if (!props || !names) {
+		ret = -FDT_ERR_NOSPACE;
+		goto out;
+	}
+
+	count = 0;
+	for (i = 0; i < nsrc; i++) {
+		fdt_for_each_property_offset(prop, src[i].fdto,
+					     src[i].offset) {
+			if (!fdt_getprop_by_offset(src[i].fdto, prop,
+						   &name, &len)) {
+				ret = len;
+				goto out;
+			}
+
+			props[count].fdto = src[i].fdto;
+			props[count].offset = prop;
+			props[count].seq = src[i].seq;
+			props[count].slot = OVERLAY_SLOT_NONE;
+			names[count].name = name;
+			names[count].first = names[count].last = count;
+			names[count].in_base = 0;
+			count++;
+		}
+	}
+
+	/* One entry per name, for both its first and its last setter */
+	_fdt_sort(names, sizeof(*names), count, overlay_cmp_propnames, NULL);
+	nnames = 0;
+	for (i = 0; i < count; i++) {
+		if (nnames && (strcmp(names[nnames - 1].name,
+				      names[i].name) == 0)) {
+			names[nnames - 1].last = names[i].first;
+			continue;
+		}
+		names[nnames++] = names[i];
+	}
+
+	if (node >= 0)
+		fdt_for_each_property_offset(prop, rb->fdt, node) {
+			if (!fdt_getprop_by_offset(rb->fdt, prop, &name, &len)) {
+				ret = len;
+				goto out;
+			}
+
+			pn = overlay_find_propname(names, nnames, name);
+			if (pn)
+				pn->in_base = 1;
+		}
 
-err:
 	/*
-	 * The overlay might have been damaged, erase its magic.
+	 * Properties new to the node go in front of the existing
+	 * ones, most recently added first, with the last value set
 	 */
-	fdt_set_magic(fdto, ~0);
+	for (i = count - 1; i >= 0; i--) {
+		fdt_getprop_by_offset(props[i].fdto, props[i].offset,
+				      &name, NULL);
+		pn = overlay_find_propname(names, nnames, name);
+		if (pn->in_base || (pn->first != i))
+			continue;
+
+		val = fdt_getprop_by_offset(props[pn->last].fdto,
+					    props[pn->last].offset,
+					    &pname, &len);
+
+		ret = overlay_emit_prop(rb, -1, name, val, len);
+		if (ret)
+			goto out;
+	}
+
+	/* The existing properties keep their place */
+	if (node < 0)
+		goto out;
+
+	fdt_for_each_property_offset(prop, rb->fdt, node) {
+		val = fdt_getprop_by_offset(rb->fdt, prop, &name, &len);
+		if (!val) {
+			ret = len;
+			goto out;
+		}
+
+		pn = overlay_find_propname(names, nnames, name);
+		if (pn)
+			val = fdt_getprop_by_offset(props[pn->last].fdto,
+						    props[pn->last].offset,
+						    &pname, &len);
+
+		ret = overlay_emit_prop(rb, prop, name, val, len);
+		if (ret)
+			goto out;
+	}
+
+out:
+	rb->wsused = mark;
+	return ret;
+}
+
+static int overlay_emit_base_node(struct overlay_rebuild *rb, int node,
+				  const struct overlay_item *src, int nsrc);
+static int overlay_emit_new_node(struct overlay_rebuild *rb,
+				 const struct overlay_item *src, int nsrc);
+
+/**
+ * overlay_emit_slot - Writes one child of a merged node
+ * @rb: rebuild state
+ * @subs: overlay subnodes of the merged node
+ * @count: number of overlay subnodes
+ * @slot: which child to write
+ *
+ * returns:
+ *      for a base node, the offset following it in the base tree
+ *      0 for a new node
+ *      Negative error code on failure
+ */
+static int overlay_emit_slot(struct overlay_rebuild *rb,
+			     const struct overlay_item *subs, int count,
+			     int slot)
+{
+	struct overlay_item *src;
+	int mark, nsrc, i;
+	int ret;
+
+	mark = rb->wsused;
+
+	nsrc = 0;
+	for (i = 0; i < count; i++)
+		if (subs[i].slot == slot)
+			nsrc++;
+
+	src = overlay_ws_alloc(rb, nsrc * sizeof(*src));
+	if (!src)
+		return -FDT_ERR_NOSPACE;
+
+	nsrc = 0;
+	for (i = 0; i < count; i++)
+		if (subs[i].slot == slot)
+			src[nsrc++] = subs[i];
+
+	if (slot >= 0)
+		ret = overlay_emit_base_node(rb, slot, src, nsrc);
+	else
+		ret = overlay_emit_new_node(rb, src, nsrc);
+
+	rb->wsused = mark;
+	return ret;
+}
+
+/**
+ * overlay_emit_children - Writes the subnodes of a merged node
+ * @rb: rebuild state
+ * @node: offset of the node in the base tree, or -1 for a new node
+ * @offset: offset of the first subnode of @node in the base tree
+ * @src: overlay nodes merged into @node, in application order
+ * @nsrc: number of overlay nodes
+ *
+ * returns:
+ *      for a base node, the offset of its FDT_END_NODE tag
+ *      0 for a new node
+ *      Negative error code on failure
+ */
+static int overlay_emit_children(struct overlay_rebuild *rb, int node,
+				 int offset, const struct overlay_item *src,
+				 int nsrc)
+{
+	struct overlay_item *subs;
+	const char *name;
+	int count, ncreated, mark, subnode, child, nextoffset, depth, len;
+	int *creators;
+	uint32_t tag;
+	int i, k;
+	int ret;
+
+	mark = rb->wsused;
+
+	/* The overlay subnodes, in the order they would be added */
+	count = 0;
+	for (i = 0; i < nsrc; i++)
+		fdt_for_each_subnode(subnode, src[i].fdto, src[i].offset)
+			count++;
+
+	subs = overlay_ws_alloc(rb, count * sizeof(*subs));
+	creators = overlay_ws_alloc(rb, count * sizeof(*creators));
+	if (!subs || !creators)
+		return -FDT_ERR_NOSPACE;
+
+	count = 0;
+	for (i = 0; i < nsrc; i++) {
+		fdt_for_each_subnode(subnode, src[i].fdto, src[i].offset) {
+			subs[count].fdto = src[i].fdto;
+			subs[count].offset = subnode;
+			subs[count].seq = src[i].seq;
+			subs[count].slot = OVERLAY_SLOT_NONE;
+			count++;
+		}
+	}
+
+	/* The first base subnode each of them would match */
+	for (child = offset, depth = 0; node >= 0; child = nextoffset) {
+		tag = fdt_next_tag(rb->fdt, child, &nextoffset);
+		if (nextoffset < 0)
+			return nextoffset;
+
+		if (tag == FDT_END_NODE) {
+			if (--depth < 0)
+				break;
+		} else if ((tag == FDT_BEGIN_NODE) && (depth++ == 0)) {
+			name = fdt_get_name(rb->fdt, child, &len);
+			if (!name)
+				return len;
+
+			for (i = 0; i < count; i++) {
+				const char *sname;
+				int slen;
+
+				if (subs[i].slot != OVERLAY_SLOT_NONE)
+					continue;
+
+				sname = fdt_get_name(subs[i].fdto,
+						     subs[i].offset, &slen);
+				if (sname && overlay_nodename_eq(name, len,
+								 sname, slen))
+					subs[i].slot = child;
+			}
+		} else if (tag == FDT_END) {
+			return -FDT_ERR_BADSTRUCTURE;
+		}
+	}
 
 	/*
-	 * The base device tree might have been damaged, erase its
-	 * magic.
+	 * Nodes added earlier sit in front of the base subnodes, so
+	 * are matched first
 	 */
-	fdt_set_magic(fdt, ~0);
+	ncreated = 0;
+	for (i = 0; i < count; i++) {
+		for (k = ncreated - 1; k >= 0; k--)
+			if (overlay_item_nodename_eq(&subs[creators[k]],
+						     &subs[i]))
+				break;
+
+		if (k >= 0) {
+			subs[i].slot = OVERLAY_SLOT_NEW(k);
+		} else if (subs[i].slot == OVERLAY_SLOT_NONE) {
+			subs[i].slot = OVERLAY_SLOT_NEW(ncreated);
+			creators[ncreated++] = i;
+		}
+	}
+
+	/* New nodes first, most recently added first */
+	for (k = ncreated - 1; k >= 0; k--) {
+		ret = overlay_emit_slot(rb, subs, count, OVERLAY_SLOT_NEW(k));
+		if (ret < 0)
+			return ret;
+	}
 
+	/* Then the base subnodes, in order */
+	ret = 0;
+	for (child = offset; node >= 0; ) {
+		tag = fdt_next_tag(rb->fdt, child, &nextoffset);
+		if (nextoffset < 0)
+			return nextoffset;
+
+		if (tag == FDT_NOP) {
+			child = nextoffset;
+			continue;
+		}
+		if (tag != FDT_BEGIN_NODE) {
+			ret = child;
+			break;
+		}
+
+		child = overlay_emit_slot(rb, subs, count, child);
+		if (child < 0)
+			return child;
+	}
+
+	rb->wsused = mark;
 	return ret;
 }
+
+/**
+ * overlay_emit_base_node - Writes a base node, and the overlays on it
+ * @rb: rebuild state
+ * @node: offset of the node in the base tree
+ * @src: overlay nodes merged into it through its parents
+ * @nsrc: number of overlay nodes
+ *
+ * Fragments targeting @node itself are picked up here, so base nodes
+ * must be written in the order they appear in the base tree.
+ *
+ * returns:
+ *      the offset following the node in the base tree
+ *      Negative error code on failure
+ */
+static int overlay_emit_base_node(struct overlay_rebuild *rb, int node,
+				  const struct overlay_item *src, int nsrc)
+{
+	const struct fdt_property *prop;
+	struct overlay_item *all;
+	const char *name;
+	int offset, nextoffset, mark, ndirect, len;
+	uint32_t tag;
+	int i, j, k;
+	int ret;
+
+	mark = rb->wsused;
+
+	ndirect = 0;
+	while (((rb->nextfrag + ndirect) < rb->nfrags)
+	       && (rb->frags[rb->nextfrag + ndirect].slot == node))
+		ndirect++;
+
+	if (ndirect) {
+		const struct overlay_item *direct = rb->frags + rb->nextfrag;
+
+		all = overlay_ws_alloc(rb, (nsrc + ndirect) * sizeof(*all));
+		if (!all)
+			return -FDT_ERR_NOSPACE;
+
+		for (i = j = k = 0; (i < nsrc) || (j < ndirect); k++) {
+			if ((j == ndirect)
+			    || ((i < nsrc) && (src[i].seq < direct[j].seq)))
+				all[k] = src[i++];
+			else
+				all[k] = direct[j++];
+		}
+
+		rb->nextfrag += ndirect;
+		src = all;
+		nsrc += ndirect;
+	}
+
+	name = fdt_get_name(rb->fdt, node, &len);
+	if (!name)
+		return len;
+
+	ret = fdt_begin_node(rb->out, name);
+	if (ret)
+		return ret;
+
+	if (nsrc) {
+		ret = overlay_emit_props(rb, node, src, nsrc);
+		if (ret)
+			return ret;
+	}
+
+	/* Walk, or copy, the base properties */
+	fdt_next_tag(rb->fdt, node, &offset);
+	for (;;) {
+		tag = fdt_next_tag(rb->fdt, offset, &nextoffset);
+		if (nextoffset < 0)
+			return nextoffset;
+
+		if (tag == FDT_PROP) {
+			if (!nsrc) {
+				prop = fdt_get_property_by_offset(rb->fdt,
+								  offset,
+								  &len);
+				if (!prop)
+					return len;
+
+				ret = overlay_emit_prop(rb, offset, NULL,
+							prop->data, len);
+				if (ret)
+					return ret;
+			}
+		} else if (tag != FDT_NOP) {
+			break;
+		}
+
+		offset = nextoffset;
+	}
+
+	if (nsrc) {
+		offset = overlay_emit_children(rb, node, offset, src, nsrc);
+		if (offset < 0)
+			return offset;
+	} else {
+		while ((tag = fdt_next_tag(rb->fdt, offset, &nextoffset))
+		       != FDT_END_NODE) {
+			if (nextoffset < 0)
+				return nextoffset;
+
+			if (tag == FDT_NOP) {
+				offset = nextoffset;
+				continue;
+			}
+			if (tag != FDT_BEGIN_NODE)
+				return -FDT_ERR_BADSTRUCTURE;
+
+			offset = overlay_emit_base_node(rb, offset, NULL, 0);
+			if (offset < 0)
+				return offset;
+		}
+	}
+
+	tag = fdt_next_tag(rb->fdt, offset, &nextoffset);
+	if (nextoffset < 0)
+		return nextoffset;
+	if (tag != FDT_END_NODE)
+		return -FDT_ERR_BADSTRUCTURE;
+
+	ret = fdt_end_node(rb->out);
+	if (ret)
+		return ret;
+
+	rb->wsused = mark;
+	return nextoffset;
+}
+
+/**
+ * overlay_emit_new_node - Writes a node added by the overlays
+ * @rb: rebuild state
+ * @src: overlay nodes making up the new node, in application order
+ * @nsrc: number of overlay nodes
+ *
+ * returns:
+ *      0 on success
+ *      Negative error code on failure
+ */
+static int overlay_emit_new_node(struct overlay_rebuild *rb,
+				 const struct overlay_item *src, int nsrc)
+{
+	const char *name;
+	int len;
+	int ret;
+
+	name = fdt_get_name(src[0].fdto, src[0].offset, &len);
+	if (!name)
+		return len;
+
+	ret = fdt_begin_node(rb->out, name);
+	if (ret)
+		return ret;
+
+	ret = overlay_emit_props(rb, -1, src, nsrc);
+	if (ret)
+		return ret;
+
+	ret = overlay_emit_children(rb, -1, 0, src, nsrc);
+	if (ret)
+		return ret;
+
+	return fdt_end_node(rb->out);
+}
+
+/**
+ * overlay_rebuild_fragments - Collects the fragments to merge
+ * @rb: rebuild state
+ * @fdtos: overlays to merge, in order
+ * @n: number of overlays
+ * @nitems: upper bound of the workspace items the merge needs
+ *
+ * overlay_rebuild_fragments() resolves the target of each fragment
+ * in the base tree.  It only counts them if @rb->frags is NULL, and
+ * stores them otherwise.
+ *
+ * A target may be missing because an earlier overlay adds it, so
+ * collection stops at the first overlay, other than the first one,
+ * with a target which can't be found.  If the first overlay has one,
+ * it may be adding the target itself, which only overlay_merge() can
+ * deal with.
+ *
+ * returns:
+ *      the number of overlays collected, on success
+ *      -FDT_ERR_NOSPACE, if the first overlay has a missing target
+ *      Negative error code on failure
+ */
+static int overlay_rebuild_fragments(struct overlay_rebuild *rb,
+				     void **fdtos, int n, int *nitems)
+{
+	int fragment, overlay, target, offset, nextoffset;
+	int nfrags, i;
+	uint32_t tag;
+
+	rb->nfrags = 0;
+	*nitems = 0;
+
+	for (i = 0; i < n; i++) {
+		nfrags = rb->nfrags;
+
+		fdt_for_each_subnode(fragment, fdtos[i], 0) {
+			overlay = fdt_subnode_offset(fdtos[i], fragment,
+						     "__overlay__");
+			if (overlay == -FDT_ERR_NOTFOUND)
+				continue;
+			if (overlay < 0)
+				return overlay;
+
+			target = overlay_get_target(rb->fdt, fdtos[i],
+						    fragment, rb->phandles);
+			if (target == -FDT_ERR_NOTFOUND) {
+				rb->nfrags = nfrags;
+				return i ? i : -FDT_ERR_NOSPACE;
+			}
+			if (target < 0)
+				return target;
+
+			if (rb->frags) {
+				rb->frags[nfrags].fdto = fdtos[i];
+				rb->frags[nfrags].offset = overlay;
+				rb->frags[nfrags].seq = nfrags;
+				rb->frags[nfrags].slot = target;
+			}
+			nfrags++;
+		}
+
+		/*
+		 * Each overlay node and property turns up in at most a
+		 * few workspace arrays at once
+		 */
+		offset = 0;
+		do {
+			tag = fdt_next_tag(fdtos[i], offset, &nextoffset);
+			if (tag == FDT_BEGIN_NODE)
+				*nitems += 5;
+			else if (tag == FDT_PROP)
+				*nitems += 2;
+			offset = nextoffset;
+		} while (tag != FDT_END);
+		if (nextoffset < 0)
+			return nextoffset;
+
+		rb->nfrags = nfrags;
+	}
+
+	/* Allow for fragments being copied alongside their parents' */
+	*nitems += 2 * rb->nfrags;
+
+	return n;
+}
+
+static int overlay_cmp_fragments(const struct overlay_item *a,
+				 const struct overlay_item *b)
+{
+	if (a->slot != b->slot)
+		return a->slot - b->slot;
+	return a->seq - b->seq;
+}
+
+/**
+ * overlay_rebuild - Merges overlays by rebuilding the base tree
+ * @fdt: Base Device Tree blob
+ * @fdtos: overlays to merge, in order, with their phandles resolved
+ * @n: number of overlays
+ *
+ * overlay_rebuild() writes the merged tree in the free space at the
+ * end of @fdt's buffer, then moves it over the old one.  @fdt is left
+ * untouched on failure.
+ *
+ * returns:
+ *      the number of overlays merged (> 0), on success
+ *      -FDT_ERR_NOSPACE, if the overlays must go through
+ *		overlay_merge() instead
+ *      Negative error code on failure
+ */
+static int overlay_rebuild(void *fdt, void **fdtos, int n)
+{
+	struct overlay_rebuild rb;
+	struct overlay_item tmp;
+	char *freep, *out;
+	int freesize, idxsize, outsize, bufsize;
+	int nitems, count, i, j;
+	uint64_t address, size;
+	int ret;
+
+	/* Leave anything unusual to overlay_merge() */
+	freesize = overlay_free_space(fdt, &freep);
+	if (freesize < 0)
+		return freesize;
+
+	memset(&rb, 0, sizeof(rb));
+	rb.fdt = fdt;
+
+	/* Index the base phandles, to resolve fragment targets */
+	idxsize = fdt_index_size(fdt);
+	if (idxsize < 0)
+		return idxsize;
+	idxsize = FDT_ALIGN(idxsize, sizeof(uint64_t));
+	if (idxsize > freesize)
+		return -FDT_ERR_NOSPACE;
+
+	ret = fdt_index_build(fdt, freep, idxsize);
+	if (ret)
+		return ret;
+	rb.phandles = freep;
+
+	count = overlay_rebuild_fragments(&rb, fdtos, n, &nitems);
+	if (count < 0)
+		return count;
+
+	rb.ws = freep + idxsize;
+	rb.wssize = FDT_ALIGN((rb.nfrags + nitems) * sizeof(*rb.frags),
+			      sizeof(uint64_t));
+	if (rb.wssize > (freesize - idxsize))
+		return -FDT_ERR_NOSPACE;
+
+	rb.frags = overlay_ws_alloc(&rb, rb.nfrags * sizeof(*rb.frags));
+	ret = overlay_rebuild_fragments(&rb, fdtos, count, &nitems);
+	if (ret < 0)
+		return ret;
+
+	/* Fragments in base tree order, then in application order */
+	for (i = 1; i < rb.nfrags; i++) {
+		tmp = rb.frags[i];
+		for (j = i; (j > 0)
+			     && (overlay_cmp_fragments(&rb.frags[j - 1], &tmp) > 0);
+		     j--)
+			rb.frags[j] = rb.frags[j - 1];
+		rb.frags[j] = tmp;
+	}
+
+	out = rb.ws + rb.wssize;
+	outsize = freesize - idxsize - rb.wssize;
+
+	ret = fdt_create(out, outsize);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < fdt_num_mem_rsv(fdt); i++) {
+		ret = fdt_get_mem_rsv(fdt, i, &address, &size);
+		if (ret)
+			return ret;
+		ret = fdt_add_reservemap_entry(out, address, size);
+		if (ret)
+			return ret;
+	}
+
+	ret = fdt_finish_reservemap(out);
+	if (ret)
+		return ret;
+
+	ret = _fdt_sw_add_strings(out, fdt_string(fdt, 0),
+				  fdt_size_dt_strings(fdt));
+	if (ret)
+		return ret;
+	rb.strbase = -fdt_size_dt_strings(fdt);
+	rb.out = out;
+
+	ret = overlay_emit_base_node(&rb, 0, NULL, 0);
+	if (ret < 0)
+		return ret;
+
+	if (rb.nextfrag != rb.nfrags)
+		return -FDT_ERR_INTERNAL;
+
+	ret = fdt_finish(out);
+	if (ret)
+		return ret;
+
+	fdt_set_boot_cpuid_phys(out, fdt_boot_cpuid_phys(fdt));
+
+	bufsize = fdt_totalsize(fdt);
+	memmove(fdt, out, fdt_totalsize(out));
+	fdt_set_totalsize(fdt, bufsize);
+	_fdt_bump_generation();
+
+	return count;
+}
+
+/**
+ * overlay_merge_many - Merge overlays into their base device tree
+ * @fdt: Base Device Tree blob
+ * @fdtos: overlays to merge, in order, with their phandles resolved
+ * @n: number of overlays
+ *
+ * overlay_merge_many() merges as many of the overlays as it can in a
+ * single rebuild of the base tree, or all of them one at a time with
+ * overlay_merge() if there is not enough room to rebuild.
+ *
+ * returns:
+ *      the number of overlays merged (> 0), on success
+ *      Negative error code on failure
+ */
+static int overlay_merge_many(void *fdt, void **fdtos, int n)
+{
+	int ret, i;
+
+	ret = overlay_rebuild(fdt, fdtos, n);
+	if (ret != -FDT_ERR_NOSPACE)
+		return ret;
+
+	for (i = 0; i < n; i++) {
+		ret = overlay_merge(fdt, fdtos[i]);
+		if (ret)
+			return ret;
+	}
+
+	return n;
+}
+
+/*
+ * Sizing
+ *
+ * The functions below go over an overlay the way overlay_merge() would
+ * apply it, adding up what each fdt_setprop() and fdt_add_subnode()
+ * would splice into the base tree, without changing either tree.
+ */
+
+/*
+ * Property names are counted over windows of this many bytes of the
+ * overlay's strings block, one bit per byte on the stack
+ */
+#define OVERLAY_NAME_WINDOW	4096
+
+/**
+ * overlay_mark_names - Marks the names of the properties an overlay merges
+ * @fdto: Device tree overlay blob
+ * @start: offset in the overlay's strings block of the window to mark
+ * @marks: bitmap of the window, one bit per byte of strings block
+ *
+ * Properties are merged from the __overlay__ nodes of the overlay's
+ * fragments, and below.
+ *
+ * returns:
+ *      0 on success
+ *      Negative error code on failure
+ */
+static int overlay_mark_names(const void *fdto, int start, uint8_t *marks)
+{
+	const struct fdt_property *prop;
+	const char *name;
+	int offset, nextoffset, depth, merging;
+	int nameoff;
+	uint32_t tag;
+
+	depth = merging = 0;
+	offset = 0;
+	do {
+		tag = fdt_next_tag(fdto, offset, &nextoffset);
+
+		if (tag == FDT_BEGIN_NODE) {
+			depth++;
+			if ((depth == 3) && !merging) {
+				name = fdt_get_name(fdto, offset, NULL);
+				merging = name && !strcmp(name, "__overlay__");
+			}
+		} else if (tag == FDT_END_NODE) {
+			if (--depth < 3)
+				merging = 0;
+		} else if ((tag == FDT_PROP) && merging) {
+			prop = fdt_offset_ptr(fdto, offset, sizeof(*prop));
+			if (!prop)
+				return -FDT_ERR_BADSTRUCTURE;
+
+			nameoff = fdt32_to_cpu(prop->nameoff) - start;
+			if ((nameoff >= 0) && (nameoff < OVERLAY_NAME_WINDOW))
+				marks[nameoff / 8] |= 1 << (nameoff % 8);
+		}
+
+		offset = nextoffset;
+	} while (tag != FDT_END);
+
+	return (nextoffset < 0) ? nextoffset : 0;
+}
+
+/**
+ * overlay_size_names - Bytes property names add to the strings block
+ * @fdt: Base Device Tree blob
+ * @fdto: Device tree overlay blob
+ *
+ * Each string of the overlay's strings block is counted once, if a
+ * property the overlay merges is named by it and the base tree's
+ * strings block doesn't have it yet.
+ *
+ * returns:
+ *      the number of bytes (>= 0)
+ *      Negative error code on failure
+ */
+static int overlay_size_names(const void *fdt, const void *fdto)
+{
+	uint8_t marks[OVERLAY_NAME_WINDOW / 8];
+	const char *strings = fdt_string(fdto, 0);
+	int strsize = fdt_size_dt_strings(fdto);
+	int start, i, len;
+	int size = 0;
+	int ret;
+
+	for (start = 0; start < strsize; start += OVERLAY_NAME_WINDOW) {
+		memset(marks, 0, sizeof(marks));
+		ret = overlay_mark_names(fdto, start, marks);
+		if (ret)
+			return ret;
+
+		for (i = 0; (i < OVERLAY_NAME_WINDOW) && (start + i < strsize);
+		     i++) {
+			if (!(marks[i / 8] & (1 << (i % 8))))
+				continue;
+
+			len = strnlen(strings + start + i,
+				      strsize - start - i);
+			if (len == strsize - start - i)
+				return -FDT_ERR_BADSTRUCTURE;
+
+			if (!_fdt_find_string(fdt_string(fdt, 0),
+					      fdt_size_dt_strings(fdt),
+					      strings + start + i))
+				size += len + 1;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * overlay_size_target - Finds a fragment's target without fixing it up
+ * @fdt: Base Device Tree blob
+ * @fdto: Device tree overlay blob, with its phandles unresolved
+ * @fragment: node offset of the fragment in the overlay
+ *
+ * overlay_size_target() is overlay_get_target(), except that a target
+ * still waiting for its fixup is looked up through the overlay's
+ * __fixups__ and the base tree's __symbols__.
+ *
+ * returns:
+ *      the targetted node offset in the base device tree
+ *      -FDT_ERR_NOTFOUND, if the target isn't in the base tree (yet)
+ *      Negative error code on error
+ */
+static int overlay_size_target(const void *fdt, const void *fdto,
+			       int fragment)
+{
+	const char *fname, *value, *label, *path;
+	int fixups_off, symbols_off, property;
+	int fnamelen, len, n;
+
+	if (overlay_get_target_phandle(fdto, fragment) != (uint32_t)-1)
+		return overlay_get_target(fdt, fdto, fragment, NULL);
+
+	fname = fdt_get_name(fdto, fragment, &fnamelen);
+	if (!fname)
+		return fnamelen;
+
+	fixups_off = fdt_path_offset(fdto, "/__fixups__");
+	if (fixups_off < 0)
+		return (fixups_off == -FDT_ERR_NOTFOUND)
+			? -FDT_ERR_BADPHANDLE : fixups_off;
+
+	/* Find the label whose fixups include "/<fragment>:target:0" */
+	fdt_for_each_property_offset(property, fdto, fixups_off) {
+		value = fdt_getprop_by_offset(fdto, property, &label, &len);
+		if (!value)
+			return len;
+
+		for (; len > 0; value += n + 1, len -= n + 1) {
+			n = strnlen(value, len);
+			if ((n != fnamelen + 10) || (value[0] != '/')
+			    || memcmp(value + 1, fname, fnamelen)
+			    || memcmp(value + 1 + fnamelen, ":target:0", 9))
+				continue;
+
+			symbols_off = fdt_path_offset(fdt, "/__symbols__");
+			if (symbols_off < 0)
+				return symbols_off;
+
+			path = fdt_getprop(fdt, symbols_off, label, &len);
+			if (!path)
+				return len;
+
+			return fdt_path_offset(fdt, path);
+		}
+	}
+
+	return -FDT_ERR_BADPHANDLE;
+}
+
+/**
+ * overlay_size_node - Room needed to merge an overlay node
+ * @fdt: Base Device Tree blob
+ * @target: offset of the node it merges into, or -1 for a new node
+ * @fdto: Device tree overlay blob
+ * @node: Node offset in the overlay holding the changes to merge
+ *
+ * Values that shrink give back room, but only once set, so they are
+ * counted as needing none.  The names of new properties are left to
+ * overlay_size_names().
+ *
+ * returns:
+ *      the number of bytes (>= 0)
+ *      Negative error code on failure
+ */
+static int overlay_size_node(const void *fdt, int target,
+			     const void *fdto, int node)
+{
+	const struct fdt_property *prop;
+	const char *name;
+	int property, subnode, nnode;
+	int size = 0;
+	int len, oldlen, ret;
+
+	fdt_for_each_property_offset(property, fdto, node) {
+		if (!fdt_getprop_by_offset(fdto, property, &name, &len))
+			return len;
+
+		prop = NULL;
+		if (target >= 0)
+			prop = fdt_get_property(fdt, target, name, &oldlen);
+
+		if (prop) {
+			if (FDT_TAGALIGN(len) > FDT_TAGALIGN(oldlen))
+				size += FDT_TAGALIGN(len)
+					- FDT_TAGALIGN(oldlen);
+			continue;
+		}
+
+		size += sizeof(struct fdt_property) + FDT_TAGALIGN(len);
+	}
+
+	fdt_for_each_subnode(subnode, fdto, node) {
+		name = fdt_get_name(fdto, subnode, &len);
+		if (!name)
+			return len;
+
+		nnode = -1;
+		if (target >= 0) {
+			nnode = fdt_subnode_offset(fdt, target, name);
+			if ((nnode < 0) && (nnode != -FDT_ERR_NOTFOUND))
+				return nnode;
+		}
+
+		if (nnode < 0)
+			size += sizeof(struct fdt_node_header)
+				+ FDT_TAGALIGN(len + 1) + FDT_TAGSIZE;
+
+		ret = overlay_size_node(fdt, nnode, fdto, subnode);
+		if (ret < 0)
+			return ret;
+		size += ret;
+	}
+
+	return size;
+}
+
+/**
+ * overlay_prepare - Shift an overlay's phandles above the base ones
+ * @fdto: Device tree overlay blob
+ * @max_phandle: highest phandle in use, updated to cover the overlay
+ *
+ * returns:
+ *      0 on success
+ *      Negative error code on failure
+ */
+static int overlay_prepare(void *fdto, uint32_t *max_phandle)
+{
+	uint32_t delta = *max_phandle;
+	uint32_t fdto_max;
+	int ret;
+
+	ret = overlay_adjust_local_phandles(fdto, delta);
+	if (ret)
+		return ret;
+
+	ret = overlay_update_local_references(fdto, delta);
+	if (ret)
+		return ret;
+
+	/*
+	 * The overlay's phandles are now all above delta, and are
+	 * about to be merged into the base tree.
+	 */
+	fdto_max = fdt_get_max_phandle(fdto);
+	if (fdto_max == (uint32_t)-1)
+		return -FDT_ERR_BADSTRUCTURE;
+
+	if (fdto_max > *max_phandle)
+		*max_phandle = fdto_max;
+
+	return 0;
+}
+
+int fdt_overlay_apply_max_phandle(void *fdt, void *fdto,
+				  uint32_t *max_phandle)
+{
+	uint32_t new_max = *max_phandle;
+	int ret;
+
+	FDT_CHECK_HEADER(fdt);
+	FDT_CHECK_HEADER(fdto);
+
+	ret = overlay_prepare(fdto, &new_max);
+	if (ret)
+		goto err;
+
+	ret = overlay_fixup_phandles(fdt, fdto, overlay_symbol_index(fdt));
+	if (ret)
+		goto err;
+
+	ret = overlay_merge_many(fdt, &fdto, 1);
+	if (ret < 0)
+		goto err;
+
+	/*
+	 * The overlay has been damaged, erase its magic.
+	 */
+	fdt_set_magic(fdto, ~0);
+
+	*max_phandle = new_max;
+
+	return 0;
+
+err:
+	/*
+	 * The overlay might have been damaged, erase its magic.
+	 */
+	fdt_set_magic(fdto, ~0);
+
+	/*
+	 * The base device tree might have been damaged, erase its
+	 * magic.
+	 */
+	fdt_set_magic(fdt, ~0);
+
+	return ret;
+}
+
+int fdt_overlay_apply(void *fdt, void *fdto)
+{
+	uint32_t max_phandle = fdt_get_max_phandle(fdt);
+
+	return fdt_overlay_apply_max_phandle(fdt, fdto, &max_phandle);
+}
+
+int fdt_overlay_apply_many(void *fdt, void **fdtos, int n)
+{
+	uint32_t max_phandle = fdt_get_max_phandle(fdt);
+	int start, end, i;
+	void *symbols;
+	int ret;
+
+	FDT_CHECK_HEADER(fdt);
+	for (i = 0; i < n; i++)
+		FDT_CHECK_HEADER(fdtos[i]);
+
+	/* Each overlay's phandles go above those of the ones before */
+	for (i = 0; i < n; i++) {
+		ret = overlay_prepare(fdtos[i], &max_phandle);
+		if (ret)
+			goto err;
+	}
+
+	for (start = 0; start < n; start += ret) {
+		/*
+		 * Resolve against the base tree as it stands.  A
+		 * missing label may be added by an overlay not merged
+		 * yet, so merge those before retrying.
+		 */
+		symbols = overlay_symbol_index(fdt);
+		for (end = start; end < n; end++) {
+			ret = overlay_fixup_phandles(fdt, fdtos[end],
+						     symbols);
+			if ((ret == -FDT_ERR_NOTFOUND) && (end > start))
+				break;
+			if (ret)
+				goto err;
+		}
+
+		ret = overlay_merge_many(fdt, fdtos + start, end - start);
+		if (ret < 0)
+			goto err;
+	}
+
+	/*
+	 * The overlays have been damaged, erase their magic.
+	 */
+	for (i = 0; i < n; i++)
+		fdt_set_magic(fdtos[i], ~0);
+
+	return 0;
+
+err:
+	/*
+	 * The overlays might have been damaged, erase their magic.
+	 */
+	for (i = 0; i < n; i++)
+		fdt_set_magic(fdtos[i], ~0);
+
+	/*
+	 * The base device tree might have been damaged, erase its
+	 * magic.
+	 */
+	fdt_set_magic(fdt, ~0);
+
+	return ret;
+}
+
+int fdt_overlay_apply_into(const void *fdt, const void *fdto,
+			   void *out, int outsize)
+{
+	void *fdto_copy;
+	int ovoff;
+	int ret;
+
+	FDT_CHECK_HEADER(fdt);
+	FDT_CHECK_HEADER(fdto);
+
+	/*
+	 * Applying changes the overlay, so apply a copy of it, kept at
+	 * the end of @out past the tree being written
+	 */
+	if (outsize < (int)fdt_totalsize(fdto))
+		return -FDT_ERR_NOSPACE;
+	ovoff = (outsize - fdt_totalsize(fdto)) & ~(sizeof(uint64_t) - 1);
+
+	ret = fdt_open_into(fdt, out, ovoff);
+	if (ret)
+		return ret;
+
+	fdto_copy = (char *)out + ovoff;
+	memcpy(fdto_copy, fdto, fdt_totalsize(fdto));
+
+	ret = fdt_overlay_apply(out, fdto_copy);
+	if (ret)
+		return ret;
+
+	/* The copy is spent, its room is free space for the tree */
+	fdt_set_totalsize(out, outsize);
+
+	return 0;
+}
+
+int fdt_overlay_size_needed(const void *fdt, const void *fdto)
+{
+	int fragment, overlay, target;
+	int size = 0;
+	int ret;
+
+	FDT_CHECK_HEADER(fdt);
+	FDT_CHECK_HEADER(fdto);
+
+	fdt_for_each_subnode(fragment, fdto, 0) {
+		overlay = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (overlay == -FDT_ERR_NOTFOUND)
+			continue;
+		if (overlay < 0)
+			return overlay;
+
+		/*
+		 * A target an earlier overlay adds is, for now, as good
+		 * as empty
+		 */
+		target = overlay_size_target(fdt, fdto, fragment);
+		if (target == -FDT_ERR_NOTFOUND)
+			target = -1;
+		else if (target < 0)
+			return target;
+
+		ret = overlay_size_node(fdt, target, fdto, overlay);
+		if (ret < 0)
+			return ret;
+		size += ret;
+	}
+
+	ret = overlay_size_names(fdt, fdto);
+	if (ret < 0)
+		return ret;
+
+	return size + ret;
+}
+
+int fdt_overlay_apply_many_size(const void *fdt, void **fdtos, int n)
+{
+	int size;
+	int ret, i;
+
+	FDT_CHECK_HEADER(fdt);
+
+	size = fdt_totalsize(fdt);
+	for (i = 0; i < n; i++) {
+		ret = fdt_overlay_size_needed(fdt, fdtos[i]);
+		if (ret < 0)
+			return ret;
+		size += ret;
+	}
+
+	return size;
+}
@@ -88,32 +88,124 @@ static int _fdt_string_eq(const void *fdt, int stroffset,
 	return (strlen(p) == len) && (memcmp(p, s, len) == 0);
 }
 
-uint32_t fdt_get_max_phandle(const void *fdt)
+/* Returns how many times (0, 1, or 2 meaning "more") @s occurs */
+static int _fdt_find_name(const void *fdt, const char *s, int *offset)
 {
-	uint32_t max_phandle = 0;
-	int offset;
+	const char *strbase = fdt_string(fdt, 0);
+	const char *strtab = strbase;
+	int tabsize = fdt_size_dt_strings(fdt);
+	const char *p;
 
-	for (offset = fdt_next_node(fdt, -1, NULL);;
-	     offset = fdt_next_node(fdt, offset, NULL)) {
-		uint32_t phandle;
+	/* An unfinished sequential-write tree keeps its strings below
+	 * off_dt_strings, at negative offsets */
+	if (fdt_magic(fdt) == FDT_SW_MAGIC)
+		strtab -= tabsize;
 
-		if (offset == -FDT_ERR_NOTFOUND)
-			return max_phandle;
+	p = _fdt_find_string(strtab, tabsize, s);
+	if (!p)
+		return 0;
+	*offset = p - strbase;
 
-		if (offset < 0)
-			return (uint32_t)-1;
+	p++;
+	if (_fdt_find_string(p, tabsize - (p - strtab), s))
+		return 2;
+	return 1;
+}
+
+void _fdt_phandle_names_init(struct _fdt_phandle_names *pn, const void *fdt)
+{
+	int n;
+
+	pn->fdt = fdt;
+	pn->present = 0;
+	pn->exact = 1;
+
+	n = _fdt_find_name(fdt, "phandle", &pn->phandle);
+	if (n)
+		pn->present |= FDT_PHANDLE_PROP;
+	if (n > 1)
+		pn->exact = 0;
+
+	n = _fdt_find_name(fdt, "linux,phandle", &pn->linux_phandle);
+	if (n)
+		pn->present |= FDT_LINUX_PHANDLE_PROP;
+	if (n > 1)
+		pn->exact = 0;
+}
 
-		phandle = fdt_get_phandle(fdt, offset);
-		if (phandle == (uint32_t)-1)
-			continue;
+int _fdt_phandle_prop_kind(const struct _fdt_phandle_names *pn, int nameoff)
+{
+	const char *name;
 
-		if (phandle > max_phandle)
-			max_phandle = phandle;
+	if (pn->exact) {
+		if ((pn->present & FDT_PHANDLE_PROP)
+		    && (nameoff == pn->phandle))
+			return FDT_PHANDLE_PROP;
+		if ((pn->present & FDT_LINUX_PHANDLE_PROP)
+		    && (nameoff == pn->linux_phandle))
+			return FDT_LINUX_PHANDLE_PROP;
+		return 0;
 	}
 
+	name = fdt_string(pn->fdt, nameoff);
+	if (strcmp(name, "phandle") == 0)
+		return FDT_PHANDLE_PROP;
+	if (strcmp(name, "linux,phandle") == 0)
+		return FDT_LINUX_PHANDLE_PROP;
 	return 0;
 }
 
+uint32_t fdt_get_max_phandle(const void *fdt)
+{
+	struct _fdt_phandle_names pn;
+	const struct fdt_property *prop;
+	uint32_t max_phandle = 0, phandle;
+	int offset, nextoffset = 0, depth = 0;
+	uint32_t tag;
+
+	if (fdt_check_header(fdt) != 0)
+		return (uint32_t)-1;
+
+	_fdt_phandle_names_init(&pn, fdt);
+
+	/* One pass over the tags; we only need to look at properties,
+	 * not at which node they belong to */
+	do {
+		offset = nextoffset;
+		tag = fdt_next_tag(fdt, offset, &nextoffset);
+
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+			depth++;
+			break;
+
+		case FDT_END_NODE:
+			depth--;
+			break;
+
+		case FDT_PROP:
+			prop = _fdt_offset_ptr(fdt, offset);
+			if (fdt32_to_cpu(prop->len) != sizeof(fdt32_t))
+				break;
+			if (!_fdt_phandle_prop_kind(&pn,
+					fdt32_to_cpu(prop->nameoff)))
+				break;
+
+			phandle = fdt32_to_cpu(*(const fdt32_t *)prop->data);
+			if ((phandle != (uint32_t)-1) && (phandle > max_phandle))
+				max_phandle = phandle;
+			break;
+		}
+	} while (tag != FDT_END);
+
+	/* Unfinished sequential-write trees end without FDT_END */
+	if ((nextoffset < 0)
+	    && ((nextoffset != -FDT_ERR_TRUNCATED) || depth))
+		return (uint32_t)-1;
+
+	return max_phandle;
+}
+
 int fdt_get_mem_rsv(const void *fdt, int n, uint64_t *address, uint64_t *size)
 {
 	FDT_CHECK_HEADER(fdt);
@@ -180,7 +272,116 @@ int fdt_subnode_offset(const void *fdt, int parentoffset,
 	return fdt_subnode_offset_namelen(fdt, parentoffset, name, strlen(name));
 }
 
-int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
+/*
+ * Path cache.  Each slot remembers one step of a path lookup: the
+ * subnode found under a node for a given name, or the property of
+ * /aliases holding a given alias.  A slot is only trusted if the name
+ * it was filled for still matches the node or property it points to,
+ * and as the first match was recorded, such a name can only be the
+ * one looked up, so the hash only decides where slots go.
+ */
+static uint32_t _fdt_path_hash(int parent, const char *s, int len)
+{
+	uint32_t hash = 2166136261U ^ (uint32_t)parent;
+
+	while (len--) {
+		hash ^= (unsigned char)*s++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static void _fdt_path_cache_reset(struct _fdt_path_cache *pc,
+				  const void *fdt)
+{
+	int i;
+
+	for (i = 0; i < pc->nslots; i++)
+		pc->slots[i].offset = -1;
+	_fdt_index_tag_set(&pc->tag, fdt);
+}
+
+static int _fdt_subnode_offset_cached(const void *fdt,
+				      struct _fdt_path_cache *pc, int offset,
+				      const char *name, int namelen)
+{
+	struct _fdt_path_slot *slot;
+	uint32_t hash;
+	int subnode;
+
+	if (!pc || (offset < 0))
+		return fdt_subnode_offset_namelen(fdt, offset, name, namelen);
+
+	hash = _fdt_path_hash(offset, name, namelen);
+	slot = &pc->slots[hash % pc->nslots];
+	if ((slot->offset >= 0) && (slot->hash == hash)
+	    && (slot->parent == offset) && (slot->len == namelen)
+	    && _fdt_nodename_eq(fdt, slot->offset, name, namelen))
+		return slot->offset;
+
+	subnode = fdt_subnode_offset_namelen(fdt, offset, name, namelen);
+	if (subnode >= 0) {
+		slot->hash = hash;
+		slot->parent = offset;
+		slot->len = namelen;
+		slot->offset = subnode;
+	}
+
+	return subnode;
+}
+
+static int _fdt_path_offset_cached(const void *fdt,
+				   struct _fdt_path_cache *pc,
+				   const char *path, int namelen);
+
+static const char *_fdt_get_alias_cached(const void *fdt,
+					 struct _fdt_path_cache *pc,
+					 const char *name, int namelen)
+{
+	const struct fdt_property *prop;
+	struct _fdt_path_slot *slot = NULL;
+	const char *alias, *slotname;
+	uint32_t hash = 0;
+	int aliasoffset;
+
+	if (pc) {
+		hash = _fdt_path_hash(FDT_PATH_SLOT_ALIAS, name, namelen);
+		slot = &pc->slots[hash % pc->nslots];
+		if ((slot->offset >= 0) && (slot->hash == hash)
+		    && (slot->parent == FDT_PATH_SLOT_ALIAS)
+		    && (slot->len == namelen)) {
+			alias = fdt_getprop_by_offset(fdt, slot->offset,
+						      &slotname, NULL);
+			if (alias && (strlen(slotname) == namelen)
+			    && (memcmp(slotname, name, namelen) == 0))
+				return alias;
+		}
+	}
+
+	aliasoffset = _fdt_path_offset_cached(fdt, pc, "/aliases", 8);
+	if (aliasoffset < 0)
+		return NULL;
+
+	prop = fdt_get_property_namelen(fdt, aliasoffset, name, namelen,
+					NULL);
+	if (!prop)
+		return NULL;
+
+	if (slot) {
+		slot->hash = hash;
+		slot->parent = FDT_PATH_SLOT_ALIAS;
+		slot->len = namelen;
+		slot->offset = (const char *)prop
+			- (const char *)_fdt_offset_ptr(fdt, 0);
+	}
+
+	return prop->data;
+}
+
+static int _fdt_path_offset_cached(const void *fdt,
+				   struct _fdt_path_cache *pc,
+				   const char *path, int namelen)
 {
 	const char *end = path + namelen;
 	const char *p = path;
@@ -198,10 +399,10 @@ int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
 		if (!q)
 			q = end;
 
-		p = fdt_get_alias_namelen(fdt, p, q - p);
+		p = _fdt_get_alias_cached(fdt, pc, p, q - p);
 		if (!p)
 			return -FDT_ERR_BADPATH;
-		offset = fdt_path_offset(fdt, p);
+		offset = _fdt_path_offset_cached(fdt, pc, p, strlen(p));
 
 		p = q;
 	}
@@ -218,7 +419,7 @@ int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
 		if (! q)
 			q = end;
 
-		offset = fdt_subnode_offset_namelen(fdt, offset, p, q-p);
+		offset = _fdt_subnode_offset_cached(fdt, pc, offset, p, q-p);
 		if (offset < 0)
 			return offset;
 
@@ -228,6 +429,11 @@ int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
 	return offset;
 }
 
+int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
+{
+	return _fdt_path_offset_cached(fdt, NULL, path, namelen);
+}
+
 int fdt_path_offset(const void *fdt, const char *path)
 {
 	return fdt_path_offset_namelen(fdt, path, strlen(path));
@@ -389,6 +595,56 @@ const char *fdt_get_alias(const void *fdt, const char *name)
 	return fdt_get_alias_namelen(fdt, name, strlen(name));
 }
 
+int fdt_path_cache_init(const void *fdt, void *buf, int bufsize)
+{
+	struct _fdt_path_cache *pc = buf;
+
+	FDT_CHECK_HEADER(fdt);
+
+	if (bufsize < (int)(sizeof(*pc) + sizeof(pc->slots[0])))
+		return -FDT_ERR_NOSPACE;
+
+	pc->nslots = (bufsize - sizeof(*pc)) / sizeof(pc->slots[0]);
+	_fdt_path_cache_reset(pc, fdt);
+
+	return 0;
+}
+
+/* A cache left over from another tree, invalidated, or whose tree has
+ * since been resized or modified, is emptied rather than trusted */
+static struct _fdt_path_cache *_fdt_path_cache_get(const void *fdt,
+						   void *cache)
+{
+	struct _fdt_path_cache *pc = cache;
+
+	if (pc && !_fdt_index_tag_valid(&pc->tag, fdt))
+		_fdt_path_cache_reset(pc, fdt);
+
+	return pc;
+}
+
+int fdt_path_offset_namelen_cached(const void *fdt, void *cache,
+				   const char *path, int namelen)
+{
+	return _fdt_path_offset_cached(fdt, _fdt_path_cache_get(fdt, cache),
+				       path, namelen);
+}
+
+int fdt_path_offset_cached(const void *fdt, void *cache, const char *path)
+{
+	return fdt_path_offset_namelen_cached(fdt, cache, path, strlen(path));
+}
+
+const char *fdt_get_alias_cached(const void *fdt, void *cache,
+				 const char *name)
+{
+	if (fdt_check_header(fdt) != 0)
+		return NULL;
+
+	return _fdt_get_alias_cached(fdt, _fdt_path_cache_get(fdt, cache),
+				     name, strlen(name));
+}
+
 int fdt_get_path(const void *fdt, int nodeoffset, char *buf, int buflen)
 {
 	int pdepth = 0, p = 0;
@@ -106,6 +106,7 @@ static int _fdt_splice(void *fdt, void *splicepoint, int oldlen, int newlen)
 	if ((end - oldlen + newlen) > ((char *)fdt + fdt_totalsize(fdt)))
 		return -FDT_ERR_NOSPACE;
 	memmove(p + newlen, p + oldlen, end - p - oldlen);
+	_fdt_bump_generation();
 	return 0;
 }
 
@@ -220,17 +220,28 @@ static int _fdt_find_add_string(void *fdt, const char *s)
 	return offset;
 }
 
-int fdt_property_placeholder(void *fdt, const char *name, int len, void **valp)
+int _fdt_sw_add_strings(void *fdt, const char *strtab, int len)
 {
-	struct fdt_property *prop;
-	int nameoff;
+	int struct_top;
 
 	FDT_SW_CHECK_HEADER(fdt);
 
-	nameoff = _fdt_find_add_string(fdt, name);
-	if (nameoff == 0)
+	if (fdt_size_dt_strings(fdt))
+		return -FDT_ERR_BADSTATE;
+
+	struct_top = fdt_off_dt_struct(fdt) + fdt_size_dt_struct(fdt);
+	if ((len < 0) || (len > (int)(fdt_totalsize(fdt) - struct_top)))
 		return -FDT_ERR_NOSPACE;
 
+	memcpy((char *)fdt + fdt_totalsize(fdt) - len, strtab, len);
+	fdt_set_size_dt_strings(fdt, len);
+	return 0;
+}
+
+int _fdt_sw_property_nameoff(void *fdt, int nameoff, int len, void **valp)
+{
+	struct fdt_property *prop;
+
 	prop = _fdt_grab_space(fdt, sizeof(*prop) + FDT_TAGALIGN(len));
 	if (! prop)
 		return -FDT_ERR_NOSPACE;
@@ -242,6 +253,19 @@ int fdt_property_placeholder(void *fdt, const char *name, int len, void **valp)
 	return 0;
 }
 
+int fdt_property_placeholder(void *fdt, const char *name, int len, void **valp)
+{
+	int nameoff;
+
+	FDT_SW_CHECK_HEADER(fdt);
+
+	nameoff = _fdt_find_add_string(fdt, name);
+	if (nameoff == 0)
+		return -FDT_ERR_NOSPACE;
+
+	return _fdt_sw_property_nameoff(fdt, nameoff, len, valp);
+}
+
 int fdt_property(void *fdt, const char *name, const void *val, int len)
 {
 	void *ptr;
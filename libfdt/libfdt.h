@@ -303,8 +303,9 @@ const char *fdt_string(const void *fdt, int stroffset);
  * @fdt: pointer to the device tree blob
  *
  * fdt_get_max_phandle retrieves the highest phandle in the given
- * device tree. This will ignore badly formatted phandles, or phandles
- * with a value of 0 or -1.
+ * device tree, from both 'phandle' and 'linux,phandle' properties, in
+ * a single pass over the structure block. This will ignore badly
+ * formatted phandles, or phandles with a value of 0 or -1.
  *
  * returns:
  *      the highest phandle on success
@@ -748,7 +749,8 @@ const char *fdt_get_alias(const void *fdt, const char *name);
  * nodeoffset, and records that path in the buffer at buf.
  *
  * NOTE: This function is expensive, as it must scan the device tree
- * structure from the start to nodeoffset.
+ * structure from the start to nodeoffset.  See also
+ * fdt_get_path_idx().
  *
  * returns:
  *	0, on success
@@ -781,7 +783,8 @@ int fdt_get_path(const void *fdt, int nodeoffset, char *buf, int buflen);
  * will return nodeoffset itself.
  *
  * NOTE: This function is expensive, as it must scan the device tree
- * structure from the start to nodeoffset.
+ * structure from the start to nodeoffset.  See also
+ * fdt_supernode_atdepth_offset_idx().
  *
  * returns:
  *	structure block offset of the node at node offset's ancestor
@@ -806,7 +809,8 @@ int fdt_supernode_atdepth_offset(const void *fdt, int nodeoffset,
  * has depth 0, its immediate subnodes depth 1 and so forth.
  *
  * NOTE: This function is expensive, as it must scan the device tree
- * structure from the start to nodeoffset.
+ * structure from the start to nodeoffset.  See also
+ * fdt_node_depth_idx().
  *
  * returns:
  *	depth of the node at nodeoffset (>=0), on success
@@ -828,7 +832,8 @@ int fdt_node_depth(const void *fdt, int nodeoffset);
  * nodeoffset as a subnode).
  *
  * NOTE: This function is expensive, as it must scan the device tree
- * structure from the start to nodeoffset, *twice*.
+ * structure from the start to nodeoffset, *twice*.  See also
+ * fdt_parent_offset_idx().
  *
  * returns:
  *	structure block offset of the parent of the node at nodeoffset
@@ -1099,6 +1104,335 @@ int fdt_address_cells(const void *fdt, int nodeoffset);
 int fdt_size_cells(const void *fdt, int nodeoffset);
 
 
+/**********************************************************************/
+/* Lookup indexes                                                     */
+/**********************************************************************/
+
+/**
+ * fdt_index_size - determine the buffer size needed for a lookup index
+ * @fdt: pointer to the device tree blob
+ *
+ * fdt_index_size() scans the tree and returns the number of bytes
+ * which fdt_index_build() will need to index it.
+ *
+ * returns:
+ *	the required buffer size in bytes (> 0), on success
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_index_size(const void *fdt);
+
+/**
+ * fdt_index_build - build a lookup index for a device tree
+ * @fdt: pointer to the device tree blob
+ * @buf: buffer to hold the index
+ * @bufsize: size of the buffer
+ *
+ * fdt_index_build() scans the tree once and records, in the
+ * caller-supplied buffer, the offset of every node which has a
+ * phandle, sorted so that it can be searched in logarithmic time by
+ * fdt_node_offset_by_phandle_idx().  No memory is allocated.  The
+ * buffer must be suitably aligned for a pointer, and must be at
+ * least fdt_index_size() bytes long.
+ *
+ * The index refers to @fdt at its current address and contents.  It
+ * is not used, lookups silently falling back to scanning the tree,
+ * once the tree has been moved or resized, or once any tree has been
+ * modified with the read-write functions (fdt_setprop(), fdt_del_node()
+ * and so on).  Modifications made in place, with fdt_nop_node(),
+ * fdt_setprop_inplace() or through pointers into the tree, cannot be
+ * detected: after making them, rebuild the index or mark it stale with
+ * fdt_index_invalidate().
+ *
+ * returns:
+ *	0, on success
+ *	-FDT_ERR_NOSPACE, @bufsize is too small to hold the index
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_index_build(const void *fdt, void *buf, int bufsize);
+
+/**
+ * fdt_index_invalidate - mark a lookup index stale
+ * @index: index built by fdt_index_build(), fdt_symbol_index_build()
+ *	or fdt_node_index_build(), or cache set up by
+ *	fdt_path_cache_init(), or NULL
+ *
+ * fdt_index_invalidate() marks @index as no longer describing the
+ * tree it was built over, after that tree was modified.  Lookups using
+ * it then fall back to scanning the tree until it is rebuilt; a path
+ * cache is instead emptied on its next use, and refilled.
+ */
+void fdt_index_invalidate(void *index);
+
+/**
+ * fdt_node_offset_by_phandle_idx - find the node with a given phandle
+ * @fdt: pointer to the device tree blob
+ * @index: index built by fdt_index_build() over @fdt, or NULL
+ * @phandle: phandle value
+ *
+ * fdt_node_offset_by_phandle_idx() behaves exactly like
+ * fdt_node_offset_by_phandle(), but uses @index to locate the node
+ * without scanning the tree.  If @index is NULL, or is stale (see
+ * fdt_index_build()), this falls back to
+ * fdt_node_offset_by_phandle().  If more than one node carries
+ * @phandle, the first one in the tree is returned.  The node found is
+ * checked to still carry @phandle before it is returned.
+ *
+ * returns:
+ *	structure block offset of the located node (>= 0), on success
+ *	-FDT_ERR_NOTFOUND, no node with that phandle exists
+ *	-FDT_ERR_BADPHANDLE, given phandle value was invalid (0 or -1)
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE, standard meanings
+ */
+int fdt_node_offset_by_phandle_idx(const void *fdt, const void *index,
+				   uint32_t phandle);
+
+/**
+ * fdt_symbol_index_size - determine the buffer size needed for a symbol index
+ * @fdt: pointer to the device tree blob
+ *
+ * fdt_symbol_index_size() returns the number of bytes which
+ * fdt_symbol_index_build() will need to index the labels in @fdt's
+ * /__symbols__ node.
+ *
+ * returns:
+ *	the required buffer size in bytes (> 0), on success
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_symbol_index_size(const void *fdt);
+
+/**
+ * fdt_symbol_index_build - build a label lookup index for a device tree
+ * @fdt: pointer to the device tree blob
+ * @buf: buffer to hold the index
+ * @bufsize: size of the buffer
+ *
+ * fdt_symbol_index_build() records, in the caller-supplied buffer,
+ * every label in @fdt's /__symbols__ node sorted by name, so that
+ * fdt_node_offset_by_symbol_idx() can find them in logarithmic time.
+ * A tree without /__symbols__ gets an empty index.  No memory is
+ * allocated.  The buffer must be suitably aligned for a pointer, and
+ * must be at least fdt_symbol_index_size() bytes long.
+ *
+ * The index goes stale as described for fdt_index_build().
+ *
+ * returns:
+ *	0, on success
+ *	-FDT_ERR_NOSPACE, @bufsize is too small to hold the index
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_symbol_index_build(const void *fdt, void *buf, int bufsize);
+
+/**
+ * fdt_node_offset_by_symbol_idx - find the node a label refers to
+ * @fdt: pointer to the device tree blob
+ * @index: index built by fdt_symbol_index_build() over @fdt, or NULL
+ * @name: label to look up
+ *
+ * fdt_node_offset_by_symbol_idx() reads the path given for @name in
+ * @fdt's /__symbols__ node, and returns the offset of the node at
+ * that path.  Each label's path is resolved the first time it is
+ * looked up and the result kept in @index, so repeated lookups cost
+ * only a binary search.  If @index is NULL, or is stale, both steps
+ * are done by scanning the tree.
+ *
+ * returns:
+ *	structure block offset of the located node (>= 0), on success
+ *	-FDT_ERR_NOTFOUND, there is no /__symbols__ node, no label
+ *		@name in it, or no node at its path
+ *	-FDT_ERR_BADPATH, the label's path is malformed
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_node_offset_by_symbol_idx(const void *fdt, void *index,
+				  const char *name);
+
+/**
+ * fdt_path_cache_init - set up a cache for path and alias lookups
+ * @fdt: pointer to the device tree blob
+ * @buf: buffer to hold the cache
+ * @bufsize: size of the buffer
+ *
+ * fdt_path_cache_init() prepares the caller-supplied buffer as an
+ * empty cache for fdt_path_offset_cached() and fdt_get_alias_cached().
+ * The cache remembers, in a fixed number of slots, the subnodes found
+ * at each step of the paths looked up and the aliases they were
+ * given by, so that later lookups sharing a prefix with an earlier
+ * one skip the sibling scans for that prefix.  No memory is
+ * allocated.  The buffer must be suitably aligned for a pointer; any
+ * size from a few hundred bytes up is useful, a larger buffer just
+ * holds more slots.
+ *
+ * The cache is emptied, rather than used, when it is used with
+ * another tree, or after the changes that make a lookup index stale
+ * (see fdt_index_build()).  In-place modifications are not detected;
+ * after making them, call fdt_index_invalidate() on the cache or
+ * initialise it again.
+ *
+ * returns:
+ *	0, on success
+ *	-FDT_ERR_NOSPACE, @bufsize is too small to hold a single slot
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE, standard meanings
+ */
+int fdt_path_cache_init(const void *fdt, void *buf, int bufsize);
+
+/**
+ * fdt_path_offset_namelen_cached - find a tree node by its full path
+ * @fdt: pointer to the device tree blob
+ * @cache: cache set up by fdt_path_cache_init(), or NULL
+ * @path: full path of the node to locate
+ * @namelen: number of characters of path to consider
+ *
+ * Identical to fdt_path_offset_namelen(), but looks up and records
+ * the steps of the path, and any alias it starts with, in @cache.
+ */
+int fdt_path_offset_namelen_cached(const void *fdt, void *cache,
+				   const char *path, int namelen);
+
+/**
+ * fdt_path_offset_cached - find a tree node by its full path
+ * @fdt: pointer to the device tree blob
+ * @cache: cache set up by fdt_path_cache_init(), or NULL
+ * @path: full path of the node to locate
+ *
+ * Identical to fdt_path_offset(), but uses @cache as
+ * fdt_path_offset_namelen_cached() does.
+ */
+int fdt_path_offset_cached(const void *fdt, void *cache, const char *path);
+
+/**
+ * fdt_get_alias_cached - retrieve the path referenced by a given alias
+ * @fdt: pointer to the device tree blob
+ * @cache: cache set up by fdt_path_cache_init(), or NULL
+ * @name: name of the alias to look up
+ *
+ * Identical to fdt_get_alias(), but looks up and records the alias,
+ * and the /aliases node, in @cache.
+ */
+const char *fdt_get_alias_cached(const void *fdt, void *cache,
+				 const char *name);
+
+/**
+ * fdt_node_index_size - determine the buffer size needed for a node index
+ * @fdt: pointer to the device tree blob
+ *
+ * fdt_node_index_size() scans the tree and returns the number of
+ * bytes which fdt_node_index_build() will need to index it.
+ *
+ * returns:
+ *	the required buffer size in bytes (> 0), on success
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_node_index_size(const void *fdt);
+
+/**
+ * fdt_node_index_build - build an index of the tree's structure
+ * @fdt: pointer to the device tree blob
+ * @buf: buffer to hold the index
+ * @bufsize: size of the buffer
+ *
+ * fdt_node_index_build() scans the tree once and records, in the
+ * caller-supplied buffer, the parent and depth of every node, so that
+ * fdt_parent_offset_idx(), fdt_node_depth_idx(),
+ * fdt_supernode_atdepth_offset_idx() and fdt_get_path_idx() can work
+ * up from a node instead of scanning down to it from the root.  No
+ * memory is allocated.  The buffer must be suitably aligned for a
+ * pointer, and must be at least fdt_node_index_size() bytes long.
+ *
+ * The index goes stale as described for fdt_index_build().
+ *
+ * returns:
+ *	0, on success
+ *	-FDT_ERR_NOSPACE, @bufsize is too small to hold the index
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_node_index_build(const void *fdt, void *buf, int bufsize);
+
+/**
+ * fdt_get_path_idx - determine the full path of a node
+ * @fdt: pointer to the device tree blob
+ * @index: index built by fdt_node_index_build() over @fdt, or NULL
+ * @nodeoffset: offset of the node whose path to find
+ * @buf: character buffer to contain the returned path
+ * @buflen: size of the character buffer at buf
+ *
+ * fdt_get_path_idx() behaves exactly like fdt_get_path(), but builds
+ * the path from @nodeoffset's ancestors as found in @index, in time
+ * proportional to its depth.  If @index is NULL, is stale, or does
+ * not know @nodeoffset, this falls back to fdt_get_path().
+ */
+int fdt_get_path_idx(const void *fdt, const void *index, int nodeoffset,
+		     char *buf, int buflen);
+
+/**
+ * fdt_supernode_atdepth_offset_idx - find a specific ancestor of a node
+ * @fdt: pointer to the device tree blob
+ * @index: index built by fdt_node_index_build() over @fdt, or NULL
+ * @nodeoffset: offset of the node whose ancestor to find
+ * @supernodedepth: depth of the ancestor to find
+ * @nodedepth: pointer to an integer variable (will be overwritten) or NULL
+ *
+ * fdt_supernode_atdepth_offset_idx() behaves exactly like
+ * fdt_supernode_atdepth_offset(), but uses @index as
+ * fdt_get_path_idx() does.
+ */
+int fdt_supernode_atdepth_offset_idx(const void *fdt, const void *index,
+				     int nodeoffset, int supernodedepth,
+				     int *nodedepth);
+
+/**
+ * fdt_node_depth_idx - find the depth of a given node
+ * @fdt: pointer to the device tree blob
+ * @index: index built by fdt_node_index_build() over @fdt, or NULL
+ * @nodeoffset: offset of the node whose depth to find
+ *
+ * fdt_node_depth_idx() behaves exactly like fdt_node_depth(), but
+ * takes the depth from @index as fdt_get_path_idx() does.
+ */
+int fdt_node_depth_idx(const void *fdt, const void *index, int nodeoffset);
+
+/**
+ * fdt_parent_offset_idx - find the parent of a given node
+ * @fdt: pointer to the device tree blob
+ * @index: index built by fdt_node_index_build() over @fdt, or NULL
+ * @nodeoffset: offset of the node whose parent to find
+ *
+ * fdt_parent_offset_idx() behaves exactly like fdt_parent_offset(),
+ * but takes the parent from @index as fdt_get_path_idx() does.
+ */
+int fdt_parent_offset_idx(const void *fdt, const void *index, int nodeoffset);
+
 /**********************************************************************/
 /* Write-in-place functions                                           */
 /**********************************************************************/
@@ -1836,6 +2170,17 @@ int fdt_del_node(void *fdt, int nodeoffset);
  * fdt_overlay_apply() will apply the given device tree overlay on the
  * given base device tree.
  *
+ * If the free space at the end of the base tree's buffer can hold a
+ * second copy of the result, the base tree is rebuilt there with the
+ * overlay merged in, in a single pass over both trees, and moved back.
+ * Otherwise each of the overlay's properties and nodes is spliced into
+ * the base tree in place, which needs less room but moves the rest of
+ * the blob for every one of them.  Both give the same tree; leaving
+ * some slack in the buffer makes large overlays much cheaper to apply.
+ * The overlay's references to labels in the base tree are likewise
+ * resolved through an index of its __symbols__, built in the free
+ * space if it fits there (see fdt_symbol_index_size()).
+ *
  * Expect the base device tree to be modified, even if the function
  * returns an error.
  *
@@ -1859,6 +2204,144 @@ int fdt_del_node(void *fdt, int nodeoffset);
  */
 int fdt_overlay_apply(void *fdt, void *fdto);
 
+/**
+ * fdt_overlay_apply_max_phandle - Applies a DT overlay, tracking phandles
+ * @fdt: pointer to the base device tree blob
+ * @fdto: pointer to the device tree overlay blob
+ * @max_phandle: highest phandle used in @fdt, updated on success
+ *
+ * fdt_overlay_apply_max_phandle() is fdt_overlay_apply(), except that
+ * rather than scanning the base tree for its highest phandle it takes
+ * it from *@max_phandle.  On success, *@max_phandle is raised to cover
+ * the phandles brought in by the overlay, so that a sequence of
+ * overlays can be applied while scanning the base tree only once:
+ *
+ *	uint32_t max_phandle = fdt_get_max_phandle(fdt);
+ *
+ *	for (i = 0; i < n; i++)
+ *		err = fdt_overlay_apply_max_phandle(fdt, fdtos[i],
+ *						    &max_phandle);
+ *
+ * *@max_phandle must not be lower than the highest phandle actually
+ * in @fdt; a higher value only leaves a gap in the phandles used.
+ *
+ * returns:
+ *	0, on success
+ *	the same errors as fdt_overlay_apply()
+ */
+int fdt_overlay_apply_max_phandle(void *fdt, void *fdto,
+				  uint32_t *max_phandle);
+
+/**
+ * fdt_overlay_apply_many - Applies a series of DT overlays on a base DT
+ * @fdt: pointer to the base device tree blob
+ * @fdtos: pointers to the device tree overlay blobs
+ * @n: number of overlays
+ *
+ * fdt_overlay_apply_many() has the same effect as applying each of
+ * the @n overlays in turn with fdt_overlay_apply(), but does much
+ * less work doing it.  The phandles of all the overlays are resolved
+ * up front, against the base tree's __symbols__, and the overlays are
+ * then merged by rebuilding the base tree once, rather than once per
+ * overlay.  If a label or target only appears once an earlier overlay
+ * is merged, the overlays before it are merged first.
+ *
+ * As with fdt_overlay_apply(), the rebuild needs room for the result
+ * next to the current tree; without it the overlays are spliced in one
+ * at a time.
+ *
+ * Expect the base device tree to be modified, even if the function
+ * returns an error.  The overlays are damaged in any case.
+ *
+ * returns:
+ *	0, on success
+ *	the same errors as fdt_overlay_apply()
+ */
+int fdt_overlay_apply_many(void *fdt, void **fdtos, int n);
+
+/**
+ * fdt_overlay_apply_into - Applies a DT overlay, leaving both trees intact
+ * @fdt: pointer to the base device tree blob
+ * @fdto: pointer to the device tree overlay blob
+ * @out: pointer to a buffer for the merged tree
+ * @outsize: size of the @out buffer
+ *
+ * fdt_overlay_apply_into() writes to @out the tree fdt_overlay_apply()
+ * would make of @fdt, without changing either @fdt or @fdto, whether it
+ * succeeds or not.  @out must not overlap either of them.
+ *
+ * The overlay is applied to a copy of it kept at the end of @out, so
+ * @outsize must be at least the base size, plus the room the overlay
+ * needs, see fdt_overlay_size_needed(), plus the overlay's size (and up
+ * to 7 bytes for alignment).  On success the merged tree's totalsize is
+ * @outsize, whatever is left over being free space.
+ *
+ * Expect @out to be damaged if the function returns an error.
+ *
+ * returns:
+ *	0, on success
+ *	the same errors as fdt_overlay_apply()
+ */
+int fdt_overlay_apply_into(const void *fdt, const void *fdto,
+			   void *out, int outsize);
+
+/**
+ * fdt_overlay_size_needed - Room a DT overlay needs in a base DT
+ * @fdt: pointer to the base device tree blob
+ * @fdto: pointer to the device tree overlay blob, not yet applied
+ *
+ * fdt_overlay_size_needed() works out how many more bytes of structure
+ * and strings block applying @fdto to @fdt adds, without changing
+ * either tree.  Only the contents of the overlay's fragments count,
+ * not its fixup metadata, so a buffer holding @fdt with this much free
+ * space after it is enough for fdt_overlay_apply() to splice the
+ * overlay in place:
+ *
+ *	err = fdt_open_into(fdt, buf,
+ *			    fdt_totalsize(fdt) + fdt_overlay_size_needed(...));
+ *
+ * The count is exact unless several fragments set the same property or
+ * node, a value gets shorter, or a target isn't in @fdt yet; it is
+ * then an upper bound.  Since an overlay only ever needs less room
+ * once others have been applied, the counts of a series of overlays
+ * against the same base add up to enough room for the whole series.
+ *
+ * returns:
+ *	the number of bytes needed (>= 0), on success
+ *	-FDT_ERR_BADPHANDLE,
+ *	-FDT_ERR_BADOVERLAY,
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADPATH,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_overlay_size_needed(const void *fdt, const void *fdto);
+
+/**
+ * fdt_overlay_apply_many_size - Buffer size to apply a series of DT overlays
+ * @fdt: pointer to the base device tree blob
+ * @fdtos: pointers to the device tree overlay blobs, not yet applied
+ * @n: number of overlays
+ *
+ * fdt_overlay_apply_many_size() adds up fdt_overlay_size_needed() for
+ * each of @fdtos, giving the size of the smallest buffer holding @fdt
+ * that all of them can be applied in, with fdt_overlay_apply_many() or
+ * one at a time.  Neither the base tree nor the overlays are changed.
+ *
+ *	size = fdt_overlay_apply_many_size(fdt, fdtos, n);
+ *	err = fdt_open_into(fdt, buf, size);
+ *	err = fdt_overlay_apply_many(buf, fdtos, n);
+ *
+ * The overlays are then spliced in; merging them by rebuilding the tree
+ * takes more room.
+ *
+ * returns:
+ *	the buffer size in bytes (>= fdt_totalsize(fdt)), on success
+ *	the same errors as fdt_overlay_size_needed()
+ */
+int fdt_overlay_apply_many_size(const void *fdt, void **fdtos, int n);
+
 /**********************************************************************/
 /* Debugging / informational functions                                */
 /**********************************************************************/
@@ -67,6 +67,27 @@ int _fdt_check_prop_offset(const void *fdt, int offset);
 const char *_fdt_find_string(const char *strtab, int tabsize, const char *s);
 int _fdt_node_end_offset(void *fdt, int nodeoffset);
 
+/*
+ * Recognise "phandle" and "linux,phandle" properties by their name
+ * offsets rather than by comparing strings.  This is exact whenever
+ * each name appears only once in the strings block, which is always
+ * so for trees built by dtc or libfdt; otherwise it falls back to
+ * string comparison.
+ */
+#define FDT_PHANDLE_PROP	1
+#define FDT_LINUX_PHANDLE_PROP	2
+
+struct _fdt_phandle_names {
+	const void *fdt;
+	int phandle;		/* string offset of "phandle" */
+	int linux_phandle;	/* string offset of "linux,phandle" */
+	int present;		/* which of the above were found */
+	int exact;		/* no name appears more than once */
+};
+
+void _fdt_phandle_names_init(struct _fdt_phandle_names *pn, const void *fdt);
+int _fdt_phandle_prop_kind(const struct _fdt_phandle_names *pn, int nameoff);
+
 static inline const void *_fdt_offset_ptr(const void *fdt, int offset)
 {
 	return (const char *)fdt + fdt_off_dt_struct(fdt) + offset;
@@ -92,4 +113,121 @@ static inline struct fdt_reserve_entry *_fdt_mem_rsv_w(void *fdt, int n)
 
 #define FDT_SW_MAGIC		(~FDT_MAGIC)
 
+/*
+ * Sequential write helpers for code rebuilding an existing tree.
+ * _fdt_sw_add_strings() seeds the (still empty) strings block of a
+ * tree under construction with a whole existing strings block; the
+ * string at offset n in it then has offset (n - len) until
+ * fdt_finish().  _fdt_sw_property_nameoff() adds a property whose
+ * name is already in the strings block, by offset.
+ */
+int _fdt_sw_add_strings(void *fdt, const char *strtab, int len);
+int _fdt_sw_property_nameoff(void *fdt, int nameoff, int len, void **valp);
+
+/*
+ * Modification counter.  The read-write functions bump it whenever
+ * they may have moved anything in a tree's structure block, so that
+ * lookup indexes built over a tree can tell that they have gone stale.
+ */
+extern uint32_t _fdt_generation;
+
+static inline void _fdt_bump_generation(void)
+{
+	_fdt_generation++;
+}
+
+/*
+ * Every lookup index, and the path cache, starts by recording the tree
+ * it was built over, the size of its blocks and the modification
+ * counter.  Moving or resizing the tree, or modifying any tree with the
+ * read-write functions, is noticed this way; other modifications need
+ * the caller to run fdt_index_invalidate() or rebuild the index.
+ */
+struct _fdt_index_tag {
+	const void *fdt;		/* tree the index was built over */
+	uint32_t generation;		/* _fdt_generation at build time */
+	uint32_t totalsize;
+	uint32_t size_dt_struct;
+	uint32_t size_dt_strings;
+};
+
+static inline void _fdt_index_tag_set(struct _fdt_index_tag *tag,
+				      const void *fdt)
+{
+	tag->fdt = fdt;
+	tag->generation = _fdt_generation;
+	tag->totalsize = fdt_totalsize(fdt);
+	tag->size_dt_struct = fdt_size_dt_struct(fdt);
+	tag->size_dt_strings = fdt_size_dt_strings(fdt);
+}
+
+static inline int _fdt_index_tag_valid(const struct _fdt_index_tag *tag,
+				       const void *fdt)
+{
+	return tag && (tag->fdt == fdt)
+		&& (tag->generation == _fdt_generation)
+		&& (tag->totalsize == fdt_totalsize(fdt))
+		&& (tag->size_dt_struct == fdt_size_dt_struct(fdt))
+		&& (tag->size_dt_strings == fdt_size_dt_strings(fdt));
+}
+
+/*
+ * In-place heapsort, used by the index builders and the overlay code.
+ * @cmp is passed @fdt ahead of the two entries to compare.
+ */
+void _fdt_sort(void *entries, int size, int n,
+	       int (*cmp)(const void *, const void *, const void *),
+	       const void *fdt);
+
+struct _fdt_phandle_entry {
+	uint32_t phandle;
+	int offset;
+};
+
+struct _fdt_index {
+	struct _fdt_index_tag tag;
+	int nphandles;
+	struct _fdt_phandle_entry phandles[0];	/* sorted by phandle */
+};
+
+struct _fdt_node_entry {
+	int offset;
+	int parent;		/* ordinal of the parent, -1 for the root */
+	int depth;
+};
+
+struct _fdt_node_index {
+	struct _fdt_index_tag tag;
+	int nnodes;
+	struct _fdt_node_entry nodes[0];	/* in tree order */
+};
+
+#define FDT_PATH_SLOT_ALIAS	(-1)
+
+struct _fdt_path_slot {
+	uint32_t hash;
+	int parent;		/* node searched, or FDT_PATH_SLOT_ALIAS */
+	int len;		/* length of the name searched for */
+	int offset;		/* subnode or alias property, -1 if free */
+};
+
+struct _fdt_path_cache {
+	struct _fdt_index_tag tag;	/* tree the slots refer to */
+	int nslots;
+	struct _fdt_path_slot slots[0];
+};
+
+struct _fdt_symbol_entry {
+	int nameoff;		/* label, in the strings block */
+	int prop;		/* its property, or -1 once resolved */
+	int offset;		/* node the label's path resolves to */
+};
+
+struct _fdt_symbol_index {
+	struct _fdt_index_tag tag;
+	struct _fdt_path_cache *paths;	/* to resolve labels, or NULL */
+	int nsymbols;
+	struct _fdt_symbol_entry symbols[0];	/* sorted by label */
+};
+
 #endif /* _LIBFDT_INTERNAL_H */
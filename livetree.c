@@ -20,6 +20,232 @@
 
 #include "dtc.h"
 
+/*
+ * Lookup index
+ *
+ * get_subnode(), get_node_by_path(), get_node_by_label() and
+ * get_node_by_phandle() are answered from hash tables covering the live
+ * (not deleted) part of one tree, keyed on its root.  They are built on
+ * the first lookup, kept up to date as subtrees are added and labels or
+ * phandles assigned, and simply dropped, to be built again when next
+ * needed, on anything else that could change an answer: deleting or
+ * reviving a node, sorting the tree, or a second node claiming a label
+ * or phandle (where the answer depends on the tree order).
+ */
+
+struct tree_map_entry {
+	const struct node *parent;	/* children only */
+	const char *name;		/* child name or label */
+	int namelen;
+	cell_t phandle;			/* phandles only */
+	struct node *node;		/* NULL if the slot is empty */
+};
+
+struct tree_map {
+	struct tree_map_entry *slots;
+	unsigned int nslots;
+	unsigned int nused;
+};
+
+static struct {
+	struct node *root;	/* tree indexed, NULL if none or stale */
+	struct tree_map children;	/* (parent, name) -> first live child */
+	struct tree_map labels;		/* label -> first node */
+	struct tree_map phandles;	/* phandle -> first node */
+} tree_index;
+
+#define TREE_MAP_MIN_SLOTS	64
+
+static unsigned int tree_map_hash(const struct tree_map_entry *key)
+{
+	unsigned int h = 2166136261U;
+	int i;
+
+	h = (h ^ (unsigned int)(uintptr_t)key->parent) * 16777619U;
+	h = (h ^ key->phandle) * 16777619U;
+	for (i = 0; i < key->namelen; i++)
+		h = (h ^ (unsigned char)key->name[i]) * 16777619U;
+
+	return h;
+}
+
+static struct tree_map_entry *tree_map_slot(struct tree_map *map,
+					    const struct tree_map_entry *key)
+{
+	unsigned int mask = map->nslots - 1;
+	unsigned int i = tree_map_hash(key) & mask;
+	struct tree_map_entry *e;
+
+	for (e = &map->slots[i]; e->node; e = &map->slots[i]) {
+		if ((e->parent == key->parent) && (e->phandle == key->phandle)
+		    && (e->namelen == key->namelen)
+		    && !memcmp(e->name, key->name, key->namelen))
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return e;
+}
+
+static struct node *tree_map_get(struct tree_map *map,
+				 const struct node *parent, const char *name,
+				 int namelen, cell_t phandle)
+{
+	struct tree_map_entry key = {parent, name, namelen, phandle, NULL};
+
+	if (!map->nused)
+		return NULL;
+	return tree_map_slot(map, &key)->node;
+}
+
+/*
+ * Maps the key to node, unless it already maps to something.  Returns
+ * the node it now maps to.
+ */
+static struct node *tree_map_add(struct tree_map *map,
+				 const struct node *parent, const char *name,
+				 cell_t phandle, struct node *node)
+{
+	struct tree_map_entry key = {parent, name, name ? strlen(name) : 0,
+				     phandle, node};
+	struct tree_map_entry *e;
+
+	if (2 * (map->nused + 1) > map->nslots) {
+		struct tree_map_entry *old = map->slots;
+		unsigned int i, oldn = map->nslots;
+
+		map->nslots = oldn ? 2 * oldn : TREE_MAP_MIN_SLOTS;
+		map->slots = xmalloc(map->nslots * sizeof(*map->slots));
+		memset(map->slots, 0, map->nslots * sizeof(*map->slots));
+		for (i = 0; i < oldn; i++)
+			if (old[i].node)
+				*tree_map_slot(map, &old[i]) = old[i];
+		free(old);
+	}
+
+	e = tree_map_slot(map, &key);
+	if (!e->node) {
+		*e = key;
+		map->nused++;
+	}
+
+	return e->node;
+}
+
+static void tree_map_clear(struct tree_map *map)
+{
+	if (map->slots)
+		memset(map->slots, 0, map->nslots * sizeof(*map->slots));
+	map->nused = 0;
+}
+
+static void tree_index_invalidate(void)
+{
+	tree_index.root = NULL;
+}
+
+static bool phandle_is_set(cell_t phandle)
+{
+	return (phandle != 0) && (phandle != -1);
+}
+
+static bool is_ancestor(const struct node *ancestor, const struct node *node)
+{
+	for (; node; node = node->parent)
+		if (node == ancestor)
+			return true;
+	return false;
+}
+
+/*
+ * Records a label or phandle of node, added to the indexed tree along
+ * with subtree.  If some other node outside subtree already has it,
+ * which one comes first depends on where they are in the tree, so leave
+ * it to a rebuild.
+ */
+static void tree_index_claim(struct tree_map *map, const char *label,
+			     cell_t phandle, struct node *node,
+			     const struct node *subtree)
+{
+	struct node *first = tree_map_add(map, NULL, label, phandle, node);
+
+	if ((first != node) && !is_ancestor(subtree, first))
+		tree_index_invalidate();
+}
+
+static void tree_index_add_node(struct node *node, const struct node *subtree)
+{
+	struct node *child;
+	struct label *l;
+
+	for_each_label(node->labels, l)
+		tree_index_claim(&tree_index.labels, l->label, 0, node,
+				 subtree);
+	if (phandle_is_set(node->phandle))
+		tree_index_claim(&tree_index.phandles, NULL, node->phandle,
+				 node, subtree);
+
+	for_each_child(node, child) {
+		tree_map_add(&tree_index.children, node, child->name, 0,
+			     child);
+		tree_index_add_node(child, subtree);
+	}
+}
+
+static void tree_index_build(struct node *root)
+{
+	tree_map_clear(&tree_index.children);
+	tree_map_clear(&tree_index.labels);
+	tree_map_clear(&tree_index.phandles);
+	tree_index.root = root;
+	tree_index_add_node(root, root);
+}
+
+/*
+ * Is node part of the live tree, and the index up to date for that tree?
+ * If build is set, the index is (re)built for the tree when needed.
+ */
+static bool tree_index_covers(struct node *node, bool build)
+{
+	struct node *n = node;
+
+	for (; n->parent; n = n->parent)
+		if (n->deleted)
+			return false;
+	if (n->deleted)
+		return false;
+
+	if (tree_index.root != n) {
+		if (!build)
+			return false;
+		tree_index_build(n);
+	}
+
+	return true;
+}
+
+/* Labels were added to, or revived on, a node of the tree */
+static void tree_index_add_labels(struct node *node)
+{
+	struct label *l;
+
+	if (!tree_index_covers(node, false))
+		return;
+
+	for_each_label(node->labels, l)
+		tree_index_claim(&tree_index.labels, l->label, 0, node, NULL);
+}
+
+/* A subtree was just added under parent */
+static void tree_index_add_child(struct node *parent, struct node *child)
+{
+	if (child->deleted || !tree_index_covers(parent, false))
+		return;
+
+	tree_map_add(&tree_index.children, parent, child->name, 0, child);
+	tree_index_add_node(child, child);
+}
+
 /*
  * Tree building functions
  */
@@ -35,7 +261,7 @@ void add_label(struct label **labels, char *label)
 			return;
 		}
 
-	new = xmalloc(sizeof(*new));
+	new = arena_alloc(sizeof(*new));
 	memset(new, 0, sizeof(*new));
 	new->label = label;
 	new->next = *labels;
@@ -52,7 +278,7 @@ void delete_labels(struct label **labels)
 
 struct property *build_property(char *name, struct data val)
 {
-	struct property *new = xmalloc(sizeof(*new));
+	struct property *new = arena_alloc(sizeof(*new));
 
 	memset(new, 0, sizeof(*new));
 
@@ -64,7 +290,7 @@ struct property *build_property(char *name, struct data val)
 
 struct property *build_property_delete(char *name)
 {
-	struct property *new = xmalloc(sizeof(*new));
+	struct property *new = arena_alloc(sizeof(*new));
 
 	memset(new, 0, sizeof(*new));
 
@@ -99,7 +325,7 @@ struct property *reverse_properties(struct property *first)
 
 struct node *build_node(struct property *proplist, struct node *children)
 {
-	struct node *new = xmalloc(sizeof(*new));
+	struct node *new = arena_alloc(sizeof(*new));
 	struct node *child;
 
 	memset(new, 0, sizeof(*new));
@@ -116,7 +342,7 @@ struct node *build_node(struct property *proplist, struct node *children)
 
 struct node *build_node_delete(void)
 {
-	struct node *new = xmalloc(sizeof(*new));
+	struct node *new = arena_alloc(sizeof(*new));
 
 	memset(new, 0, sizeof(*new));
 
@@ -140,7 +366,10 @@ struct node *merge_nodes(struct node *old_node, struct node *new_node)
 	struct node *new_child, *old_child;
 	struct label *l;
 
-	old_node->deleted = 0;
+	if (old_node->deleted) {
+		tree_index_invalidate();
+		old_node->deleted = 0;
+	}
 
 	/* Add new node labels to old node */
 	for_each_label_withdel(new_node->labels, l)
@@ -156,7 +385,6 @@ struct node *merge_nodes(struct node *old_node, struct node *new_node)
 
 		if (new_prop->deleted) {
 			delete_property_by_name(old_node, new_prop->name);
-			free(new_prop);
 			continue;
 		}
 
@@ -169,7 +397,6 @@ struct node *merge_nodes(struct node *old_node, struct node *new_node)
 
 				old_prop->val = new_prop->val;
 				old_prop->deleted = 0;
-				free(new_prop);
 				new_prop = NULL;
 				break;
 			}
@@ -191,7 +418,6 @@ struct node *merge_nodes(struct node *old_node, struct node *new_node)
 
 		if (new_child->deleted) {
 			delete_node_by_name(old_node, new_child->name);
-			free(new_child);
 			continue;
 		}
 
@@ -209,9 +435,9 @@ struct node *merge_nodes(struct node *old_node, struct node *new_node)
 			add_child(old_node, new_child);
 	}
 
-	/* The new node contents are now merged into the old node.  Free
-	 * the new node. */
-	free(new_node);
+	/* The new node contents are now merged into the old node.  The
+	 * new node itself is left to the arena. */
+	tree_index_add_labels(old_node);
 
 	return old_node;
 }
@@ -290,6 +516,8 @@ void add_child(struct node *parent, struct node *child)
 		p = &((*p)->next_sibling);
 
 	*p = child;
+
+	tree_index_add_child(parent, child);
 }
 
 void delete_node_by_name(struct node *parent, char *name)
@@ -310,6 +538,9 @@ void delete_node(struct node *node)
 	struct property *prop;
 	struct node *child;
 
+	if (tree_index_covers(node, false))
+		tree_index_invalidate();
+
 	node->deleted = 1;
 	for_each_child(node, child)
 		delete_node(child);
@@ -337,7 +568,7 @@ void append_to_property(struct node *node,
 
 struct reserve_info *build_reserve_entry(uint64_t address, uint64_t size)
 {
-	struct reserve_info *new = xmalloc(sizeof(*new));
+	struct reserve_info *new = arena_alloc(sizeof(*new));
 
 	memset(new, 0, sizeof(*new));
 
@@ -384,7 +615,14 @@ struct dt_info *build_dt_info(unsigned int dtsflags,
 	dti->dtsflags = dtsflags;
 	dti->reservelist = reservelist;
 	dti->dt = tree;
+	dti->blob = NULL;
 	dti->boot_cpuid_phys = boot_cpuid_phys;
+	dti->used_phandles = NULL;
+	dti->num_used_phandles = dti->max_used_phandles = 0;
+	dti->next_used_phandle = 0;
+	dti->next_phandle = 0;
+	dti->blob_rsvmap_size = dti->blob_struct_size = 0;
+	dti->blob_strings_size = dti->blob_totalsize = 0;
 
 	return dti;
 }
@@ -472,21 +710,31 @@ struct marker *get_marker_label(struct node *tree, const char *label,
 	return NULL;
 }
 
-struct node *get_subnode(struct node *node, const char *nodename)
+static struct node *get_subnode_namelen(struct node *node,
+					const char *name, int namelen)
 {
 	struct node *child;
 
+	if (tree_index_covers(node, true))
+		return tree_map_get(&tree_index.children, node, name, namelen,
+				    0);
+
 	for_each_child(node, child)
-		if (streq(child->name, nodename))
+		if ((strlen(child->name) == namelen) &&
+		    strneq(child->name, name, namelen))
 			return child;
 
 	return NULL;
 }
 
+struct node *get_subnode(struct node *node, const char *nodename)
+{
+	return get_subnode_namelen(node, nodename, strlen(nodename));
+}
+
 struct node *get_node_by_path(struct node *tree, const char *path)
 {
 	const char *p;
-	struct node *child;
 
 	if (!path || ! (*path)) {
 		if (tree->deleted)
@@ -494,35 +742,36 @@ struct node *get_node_by_path(struct node *tree, const char *path)
 		return tree;
 	}
 
-	while (path[0] == '/')
-		path++;
+	for (;;) {
+		while (path[0] == '/')
+			path++;
 
-	p = strchr(path, '/');
+		p = strchr(path, '/');
+		if (!p)
+			return get_subnode(tree, path);
 
-	for_each_child(tree, child) {
-		if (p && (strlen(child->name) == p-path) &&
-				strneq(path, child->name, p-path))
-			return get_node_by_path(child, p+1);
-		else if (!p && streq(path, child->name))
-			return child;
-	}
+		tree = get_subnode_namelen(tree, path, p - path);
+		if (!tree)
+			return NULL;
 
-	return NULL;
+		path = p + 1;
+		if (!(*path))
+			return tree;
+	}
 }
 
-struct node *get_node_by_label(struct node *tree, const char *label)
+static struct node *get_node_by_label_walk(struct node *tree,
+					   const char *label)
 {
 	struct node *child, *node;
 	struct label *l;
 
-	assert(label && (strlen(label) > 0));
-
 	for_each_label(tree->labels, l)
 		if (streq(l->label, label))
 			return tree;
 
 	for_each_child(tree, child) {
-		node = get_node_by_label(child, label);
+		node = get_node_by_label_walk(child, label);
 		if (node)
 			return node;
 	}
@@ -530,11 +779,28 @@ struct node *get_node_by_label(struct node *tree, const char *label)
 	return NULL;
 }
 
-struct node *get_node_by_phandle(struct node *tree, cell_t phandle)
+struct node *get_node_by_label(struct node *tree, const char *label)
 {
-	struct node *child, *node;
+	struct node *node;
+
+	assert(label && (strlen(label) > 0));
+
+	/* The index knows the first match in the whole tree; if that is
+	 * outside the subtree asked about, there may still be one inside */
+	if (tree_index_covers(tree, true)) {
+		node = tree_map_get(&tree_index.labels, NULL, label,
+				    strlen(label), 0);
+		if (!node || is_ancestor(tree, node))
+			return node;
+	}
+
+	return get_node_by_label_walk(tree, label);
+}
 
-	assert((phandle != 0) && (phandle != -1));
+static struct node *get_node_by_phandle_walk(struct node *tree,
+					     cell_t phandle)
+{
+	struct node *child, *node;
 
 	if (tree->phandle == phandle) {
 		if (tree->deleted)
@@ -543,7 +809,7 @@ struct node *get_node_by_phandle(struct node *tree, cell_t phandle)
 	}
 
 	for_each_child(tree, child) {
-		node = get_node_by_phandle(child, phandle);
+		node = get_node_by_phandle_walk(child, phandle);
 		if (node)
 			return node;
 	}
@@ -551,6 +817,37 @@ struct node *get_node_by_phandle(struct node *tree, cell_t phandle)
 	return NULL;
 }
 
+struct node *get_node_by_phandle(struct node *tree, cell_t phandle)
+{
+	struct node *node;
+
+	assert(phandle_is_set(phandle));
+
+	if (tree_index_covers(tree, true)) {
+		node = tree_map_get(&tree_index.phandles, NULL, NULL, 0,
+				    phandle);
+		if (!node || is_ancestor(tree, node))
+			return node;
+	}
+
+	return get_node_by_phandle_walk(tree, phandle);
+}
+
+void set_node_phandle(struct node *node, cell_t phandle)
+{
+	if (tree_index_covers(node, false)) {
+		if (phandle_is_set(node->phandle)
+		    && (tree_map_get(&tree_index.phandles, NULL, NULL, 0,
+				     node->phandle) == node))
+			tree_index_invalidate();
+		else if (phandle_is_set(phandle))
+			tree_index_claim(&tree_index.phandles, NULL, phandle,
+					 node, NULL);
+	}
+
+	node->phandle = phandle;
+}
+
 struct node *get_node_by_ref(struct node *tree, const char *ref)
 {
 	if (streq(ref, "/"))
@@ -561,17 +858,68 @@ struct node *get_node_by_ref(struct node *tree, const char *ref)
 		return get_node_by_label(tree, ref);
 }
 
-cell_t get_node_phandle(struct node *root, struct node *node)
+static int cmp_phandle(const void *ax, const void *bx)
+{
+	cell_t a = *(const cell_t *)ax, b = *(const cell_t *)bx;
+
+	return (a > b) - (a < b);
+}
+
+static void collect_phandles(struct dt_info *dti, struct node *node)
+{
+	struct node *child;
+
+	if (phandle_is_set(node->phandle)) {
+		if (dti->num_used_phandles == dti->max_used_phandles) {
+			dti->max_used_phandles = dti->max_used_phandles ?
+				2 * dti->max_used_phandles : 64;
+			dti->used_phandles = xrealloc(dti->used_phandles,
+				dti->max_used_phandles *
+				sizeof(*dti->used_phandles));
+		}
+		dti->used_phandles[dti->num_used_phandles++] = node->phandle;
+	}
+
+	for_each_child(node, child)
+		collect_phandles(dti, child);
+}
+
+/*
+ * Returns the lowest phandle above those handed out before that no node
+ * of the tree uses.  The phandles already in use are gathered and sorted
+ * on the first call; by then check_explicit_phandles() has set them all.
+ */
+static cell_t alloc_phandle(struct dt_info *dti)
+{
+	if (!dti->next_phandle) {
+		collect_phandles(dti, dti->dt);
+		qsort(dti->used_phandles, dti->num_used_phandles,
+		      sizeof(*dti->used_phandles), cmp_phandle);
+		dti->next_used_phandle = 0;
+		dti->next_phandle = 1;
+	}
+
+	while ((dti->next_used_phandle < dti->num_used_phandles)
+	       && (dti->used_phandles[dti->next_used_phandle]
+		   <= dti->next_phandle)) {
+		if (dti->used_phandles[dti->next_used_phandle]
+		    == dti->next_phandle)
+			dti->next_phandle++;
+		dti->next_used_phandle++;
+	}
+
+	return dti->next_phandle++;
+}
+
+cell_t get_node_phandle(struct dt_info *dti, struct node *node)
 {
-	static cell_t phandle = 1; /* FIXME: ick, static local */
+	cell_t phandle;
 
 	if ((node->phandle != 0) && (node->phandle != -1))
 		return node->phandle;
 
-	while (get_node_by_phandle(root, phandle))
-		phandle++;
-
-	node->phandle = phandle;
+	phandle = alloc_phandle(dti);
+	set_node_phandle(node, phandle);
 
 	if (!get_property(node, "linux,phandle")
 	    && (phandle_format & PHANDLE_LEGACY))
@@ -748,10 +1096,28 @@ static void sort_node(struct node *node)
 
 void sort_tree(struct dt_info *dti)
 {
+	tree_index_invalidate();
 	sort_reserve_entries(dti);
 	sort_node(dti->dt);
 }
 
+static void shrink_node_values(struct node *node)
+{
+	struct property *prop;
+	struct node *child;
+
+	for_each_property_withdel(node, prop)
+		prop->val = data_shrink(prop->val);
+
+	for_each_child_withdel(node, child)
+		shrink_node_values(child);
+}
+
+void shrink_tree_values(struct dt_info *dti)
+{
+	shrink_node_values(dti->dt);
+}
+
 /* utility helper to avoid code duplication */
 static struct node *build_and_name_child_node(struct node *parent, char *name)
 {
@@ -796,7 +1162,6 @@ static void generate_label_tree_internal(struct dt_info *dti,
 					 struct node *an, struct node *node,
 					 bool allocph)
 {
-	struct node *dt = dti->dt;
 	struct node *c;
 	struct property *p;
 	struct label *l;
@@ -825,7 +1190,7 @@ static void generate_label_tree_internal(struct dt_info *dti,
 
 		/* force allocation of a phandle for this node */
 		if (allocph)
-			(void)get_node_phandle(dt, node);
+			(void)get_node_phandle(dti, node);
 	}
 
 	for_each_child(node, c)
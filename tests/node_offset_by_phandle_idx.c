@@ -0,0 +1,155 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_index_build() / fdt_node_offset_by_phandle_idx()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+#include "testdata.h"
+
+static void check_search(void *fdt, const void *idx, uint32_t phandle,
+			 int target)
+{
+	int offset;
+
+	offset = fdt_node_offset_by_phandle_idx(fdt, idx, phandle);
+
+	if (offset != target)
+		FAIL("fdt_node_offset_by_phandle_idx(0x%x) returns %d "
+		     "instead of %d", phandle, offset, target);
+}
+
+int main(int argc, char *argv[])
+{
+	void *fdt, *idx, *rw;
+	int subnode2_offset, subsubnode2_offset;
+	int size, err, offset;
+	uint32_t phandle;
+
+	test_init(argc, argv);
+	fdt = load_blob_arg(argc, argv);
+
+	subnode2_offset = fdt_path_offset(fdt, "/subnode@2");
+	subsubnode2_offset = fdt_path_offset(fdt, "/subnode@2/subsubnode@0");
+
+	if ((subnode2_offset < 0) || (subsubnode2_offset < 0))
+		FAIL("Can't find required nodes");
+
+	size = fdt_index_size(fdt);
+	if (size < 0)
+		FAIL("fdt_index_size(): %s", fdt_strerror(size));
+	idx = xmalloc(size);
+
+	err = fdt_index_build(fdt, idx, size - 1);
+	if (err != -FDT_ERR_NOSPACE)
+		FAIL("fdt_index_build() into short buffer returns %d "
+		     "instead of -FDT_ERR_NOSPACE", err);
+
+	err = fdt_index_build(fdt, idx, size);
+	if (err)
+		FAIL("fdt_index_build(): %s", fdt_strerror(err));
+
+	check_search(fdt, idx, PHANDLE_1, subnode2_offset);
+	check_search(fdt, idx, PHANDLE_2, subsubnode2_offset);
+	check_search(fdt, idx, ~PHANDLE_1, -FDT_ERR_NOTFOUND);
+	check_search(fdt, idx, 0, -FDT_ERR_BADPHANDLE);
+	check_search(fdt, idx, -1, -FDT_ERR_BADPHANDLE);
+
+	/* Every node's phandle must resolve back to that node */
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		phandle = fdt_get_phandle(fdt, offset);
+		if (phandle)
+			check_search(fdt, idx, phandle, offset);
+	}
+
+	/* Once marked stale after modifying the tree, the index must no
+	 * longer answer lookups */
+	err = fdt_nop_node(fdt, subsubnode2_offset);
+	if (err)
+		FAIL("fdt_nop_node(): %s", fdt_strerror(err));
+	fdt_index_invalidate(idx);
+
+	check_search(fdt, idx, PHANDLE_2, -FDT_ERR_NOTFOUND);
+
+	err = fdt_index_build(fdt, idx, size);
+	if (err)
+		FAIL("fdt_index_build(): %s", fdt_strerror(err));
+
+	check_search(fdt, idx, PHANDLE_1, subnode2_offset);
+	check_search(fdt, idx, PHANDLE_2, -FDT_ERR_NOTFOUND);
+
+	/* A missing index falls back to scanning */
+	check_search(fdt, NULL, PHANDLE_1, subnode2_offset);
+
+	/* Resizing the tree marks the index stale by itself */
+	size = fdt_totalsize(fdt) + 1024;
+	rw = xmalloc(size);
+	err = fdt_open_into(fdt, rw, size);
+	if (err)
+		FAIL("fdt_open_into(): %s", fdt_strerror(err));
+
+	err = fdt_index_build(rw, idx, fdt_index_size(rw));
+	if (err)
+		FAIL("fdt_index_build(): %s", fdt_strerror(err));
+
+	err = fdt_del_node(rw, fdt_path_offset(rw, "/subnode@2"));
+	if (err)
+		FAIL("fdt_del_node(): %s", fdt_strerror(err));
+
+	check_search(rw, idx, PHANDLE_1, -FDT_ERR_NOTFOUND);
+
+	/* So does any other change through the read-write functions,
+	 * even one that leaves the structure block the same size */
+	err = fdt_open_into(fdt, rw, size);
+	if (err)
+		FAIL("fdt_open_into(): %s", fdt_strerror(err));
+
+	err = fdt_index_build(rw, idx, fdt_index_size(rw));
+	if (err)
+		FAIL("fdt_index_build(): %s", fdt_strerror(err));
+
+	shift_nodes(rw);
+
+	check_search(rw, idx, PHANDLE_1,
+		     fdt_node_offset_by_phandle(rw, PHANDLE_1));
+
+	free(rw);
+
+	/* A node whose phandle is changed in place is no longer found by
+	 * its old one */
+	err = fdt_index_build(fdt, idx, fdt_index_size(fdt));
+	if (err)
+		FAIL("fdt_index_build(): %s", fdt_strerror(err));
+
+	err = fdt_setprop_inplace_cell(fdt, subnode2_offset, "linux,phandle",
+				       ~PHANDLE_1);
+	if (err)
+		FAIL("fdt_setprop_inplace_cell(): %s", fdt_strerror(err));
+
+	check_search(fdt, idx, PHANDLE_1, -FDT_ERR_NOTFOUND);
+
+	free(idx);
+	PASS();
+}
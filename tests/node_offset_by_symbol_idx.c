@@ -0,0 +1,151 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_symbol_index_build() / fdt_node_offset_by_symbol_idx()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+static void check_search(void *fdt, void *idx, const char *name, int target)
+{
+	int offset;
+
+	offset = fdt_node_offset_by_symbol_idx(fdt, idx, name);
+
+	if (offset != target)
+		FAIL("fdt_node_offset_by_symbol_idx(\"%s\") returns %d "
+		     "instead of %d", name, offset, target);
+}
+
+/* Every label must resolve to the node at its path */
+static void check_symbols(void *fdt, void *idx)
+{
+	const char *name, *path;
+	int symbols, property, len;
+
+	symbols = fdt_path_offset(fdt, "/__symbols__");
+	if (symbols < 0)
+		FAIL("fdt_path_offset(\"/__symbols__\"): %s",
+		     fdt_strerror(symbols));
+
+	fdt_for_each_property_offset(property, fdt, symbols) {
+		path = fdt_getprop_by_offset(fdt, property, &name, &len);
+		if (!path)
+			FAIL("fdt_getprop_by_offset(): %s", fdt_strerror(len));
+
+		check_search(fdt, idx, name, fdt_path_offset(fdt, path));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	void *fdt, *idx, *rw, *rwidx;
+	const char *name, *path;
+	int symbols, property, target, victim = -1;
+	int size, err, len;
+
+	test_init(argc, argv);
+	fdt = load_blob_arg(argc, argv);
+
+	size = fdt_symbol_index_size(fdt);
+	if (size < 0)
+		FAIL("fdt_symbol_index_size(): %s", fdt_strerror(size));
+	idx = xmalloc(size);
+
+	symbols = fdt_path_offset(fdt, "/__symbols__");
+	if ((symbols < 0) && (symbols != -FDT_ERR_NOTFOUND))
+		FAIL("fdt_path_offset(\"/__symbols__\"): %s",
+		     fdt_strerror(symbols));
+
+	if (symbols >= 0) {
+		err = fdt_symbol_index_build(fdt, idx, size - 1);
+		if (err != -FDT_ERR_NOSPACE)
+			FAIL("fdt_symbol_index_build() into short buffer "
+			     "returns %d instead of -FDT_ERR_NOSPACE", err);
+	}
+
+	err = fdt_symbol_index_build(fdt, idx, size);
+	if (err)
+		FAIL("fdt_symbol_index_build(): %s", fdt_strerror(err));
+
+	/* Every label must resolve, twice, to the node at its path */
+	if (symbols >= 0) {
+		fdt_for_each_property_offset(property, fdt, symbols) {
+			path = fdt_getprop_by_offset(fdt, property, &name,
+						     &len);
+			if (!path)
+				FAIL("fdt_getprop_by_offset(): %s",
+				     fdt_strerror(len));
+
+			target = fdt_path_offset(fdt, path);
+			check_search(fdt, idx, name, target);
+			check_search(fdt, idx, name, target);
+			check_search(fdt, NULL, name, target);
+			if (target > 0)
+				victim = target;
+		}
+	}
+
+	check_search(fdt, idx, "no-such-label", -FDT_ERR_NOTFOUND);
+	check_search(fdt, idx, "", -FDT_ERR_NOTFOUND);
+
+	/* Changes through the read-write functions mark the index stale,
+	 * even ones that leave the structure block the same size */
+	if (symbols >= 0) {
+		size = fdt_totalsize(fdt) + 1024;
+		rw = xmalloc(size);
+		err = fdt_open_into(fdt, rw, size);
+		if (err)
+			FAIL("fdt_open_into(): %s", fdt_strerror(err));
+
+		size = fdt_symbol_index_size(rw);
+		if (size < 0)
+			FAIL("fdt_symbol_index_size(): %s",
+			     fdt_strerror(size));
+		rwidx = xmalloc(size);
+		err = fdt_symbol_index_build(rw, rwidx, size);
+		if (err)
+			FAIL("fdt_symbol_index_build(): %s",
+			     fdt_strerror(err));
+		check_symbols(rw, rwidx);
+
+		shift_nodes(rw);
+		check_symbols(rw, rwidx);
+
+		free(rwidx);
+		free(rw);
+	}
+
+	/* Once marked stale after modifying the tree, the index must no
+	 * longer answer lookups */
+	if (victim >= 0) {
+		err = fdt_nop_node(fdt, victim);
+		if (err)
+			FAIL("fdt_nop_node(): %s", fdt_strerror(err));
+		fdt_index_invalidate(idx);
+
+		check_symbols(fdt, idx);
+	}
+
+	free(idx);
+	PASS();
+}
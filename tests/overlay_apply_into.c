@@ -0,0 +1,109 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_overlay_apply_into()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+static void *copy_blob(const void *fdt)
+{
+	void *copy = xmalloc(fdt_totalsize(fdt));
+
+	memcpy(copy, fdt, fdt_totalsize(fdt));
+	return copy;
+}
+
+static void check_intact(const void *fdt, const void *orig, const char *what)
+{
+	if (memcmp(fdt, orig, fdt_totalsize(orig)) != 0)
+		FAIL("%s was modified", what);
+}
+
+int main(int argc, char *argv[])
+{
+	void *base, *fdto, *base_orig, *fdto_orig;
+	void *out, *ref, *fdto_ref;
+	int size, err, referr;
+
+	test_init(argc, argv);
+	if (argc != 3)
+		CONFIG("Usage: %s <base dtb> <overlay dtb>", argv[0]);
+
+	base = load_blob(argv[1]);
+	fdto = load_blob(argv[2]);
+	base_orig = copy_blob(base);
+	fdto_orig = copy_blob(fdto);
+
+	/* Too small a buffer fails, leaving the inputs alone */
+	out = xmalloc(fdt_totalsize(base));
+	err = fdt_overlay_apply_into(base, fdto, out, fdt_totalsize(base));
+	if (err != -FDT_ERR_NOSPACE)
+		FAIL("fdt_overlay_apply_into() in %d bytes: %s",
+		     fdt_totalsize(base), fdt_strerror(err));
+	check_intact(base, base_orig, "Base tree");
+	check_intact(fdto, fdto_orig, "Overlay");
+	free(out);
+
+	/* Otherwise it does what fdt_overlay_apply() does */
+	size = 2 * (fdt_totalsize(base) + fdt_totalsize(fdto)) + 8;
+
+	ref = xmalloc(size);
+	err = fdt_open_into(base, ref, size);
+	if (err)
+		FAIL("fdt_open_into(): %s", fdt_strerror(err));
+	fdto_ref = copy_blob(fdto);
+	referr = fdt_overlay_apply(ref, fdto_ref);
+
+	out = xmalloc(size);
+	err = fdt_overlay_apply_into(base, fdto, out, size);
+	if (err != referr)
+		FAIL("fdt_overlay_apply_into(): %s, fdt_overlay_apply(): %s",
+		     fdt_strerror(err), fdt_strerror(referr));
+	check_intact(base, base_orig, "Base tree");
+	check_intact(fdto, fdto_orig, "Overlay");
+
+	if (!err) {
+		if (fdt_totalsize(out) != size)
+			FAIL("Merged tree has totalsize %d, not %d",
+			     fdt_totalsize(out), size);
+
+		err = fdt_pack(out);
+		if (!err)
+			err = fdt_pack(ref);
+		if (err)
+			FAIL("fdt_pack(): %s", fdt_strerror(err));
+
+		if ((fdt_totalsize(out) != fdt_totalsize(ref))
+		    || memcmp(out, ref, fdt_totalsize(ref)))
+			FAIL("Merged trees differ");
+	}
+
+	free(out);
+	free(ref);
+	free(fdto_ref);
+	free(base_orig);
+	free(fdto_orig);
+	free(base);
+	free(fdto);
+	PASS();
+}
@@ -0,0 +1,209 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_overlay_apply_many() and
+ *	fdt_overlay_apply_many_size()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+#define MAX_OVERLAYS	8
+
+static void **load_overlays(int n, char *names[], void **fdtos)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		fdtos[i] = load_blob(names[i]);
+
+	return fdtos;
+}
+
+static void *open_base(const char *name, int size)
+{
+	void *base = load_blob(name);
+	void *fdt = xmalloc(size);
+	int err;
+
+	err = fdt_open_into(base, fdt, size);
+	if (err)
+		FAIL("fdt_open_into(): %s", fdt_strerror(err));
+	free(base);
+
+	return fdt;
+}
+
+/*
+ * Apply an overlay in the smallest buffer it fits in, leaving no room
+ * to rebuild the tree, so that it gets spliced in place.
+ */
+static void *apply_in_place(void *fdt, const char *name)
+{
+	void *fdto, *buf;
+	int size, err;
+
+	for (size = fdt_totalsize(fdt); ; size += 64) {
+		buf = xmalloc(size);
+		err = fdt_open_into(fdt, buf, size);
+		if (err)
+			FAIL("fdt_open_into(): %s", fdt_strerror(err));
+
+		fdto = load_blob(name);
+		err = fdt_overlay_apply(buf, fdto);
+		free(fdto);
+		if (!err)
+			break;
+		if (err != -FDT_ERR_NOSPACE)
+			FAIL("fdt_overlay_apply(%s): %s", name,
+			     fdt_strerror(err));
+		free(buf);
+	}
+	free(fdt);
+
+	err = fdt_pack(buf);
+	if (err)
+		FAIL("fdt_pack(): %s", fdt_strerror(err));
+
+	return buf;
+}
+
+static void compare_trees(const void *fdt1, const void *fdt2)
+{
+	int nextoffset1 = 0, nextoffset2 = 0;
+	int offset1, offset2;
+	uint32_t tag1, tag2;
+	const struct fdt_property *prop1, *prop2;
+
+	do {
+		do {
+			offset1 = nextoffset1;
+			tag1 = fdt_next_tag(fdt1, offset1, &nextoffset1);
+		} while (tag1 == FDT_NOP);
+		do {
+			offset2 = nextoffset2;
+			tag2 = fdt_next_tag(fdt2, offset2, &nextoffset2);
+		} while (tag2 == FDT_NOP);
+
+		if (tag1 != tag2)
+			FAIL("Tag mismatch (%d != %d) at (%d, %d)",
+			     tag1, tag2, offset1, offset2);
+
+		switch (tag1) {
+		case FDT_BEGIN_NODE:
+			if (!streq(fdt_get_name(fdt1, offset1, NULL),
+				   fdt_get_name(fdt2, offset2, NULL)))
+				FAIL("Name mismatch at (%d, %d)",
+				     offset1, offset2);
+			break;
+
+		case FDT_PROP:
+			prop1 = fdt_get_property_by_offset(fdt1, offset1, NULL);
+			prop2 = fdt_get_property_by_offset(fdt2, offset2, NULL);
+			if (!streq(fdt_string(fdt1, fdt32_to_cpu(prop1->nameoff)),
+				   fdt_string(fdt2, fdt32_to_cpu(prop2->nameoff))))
+				FAIL("Property name mismatch at (%d, %d)",
+				     offset1, offset2);
+			if ((prop1->len != prop2->len)
+			    || memcmp(prop1->data, prop2->data,
+				      fdt32_to_cpu(prop1->len)))
+				FAIL("Property value mismatch at (%d, %d)",
+				     offset1, offset2);
+			break;
+		}
+	} while (tag1 != FDT_END);
+}
+
+int main(int argc, char *argv[])
+{
+	void *fdtos[MAX_OVERLAYS];
+	void *seq, *many, *base;
+	int n, size, i, err;
+
+	test_init(argc, argv);
+	if ((argc < 3) || (argc > MAX_OVERLAYS + 2))
+		CONFIG("Usage: %s <base dtb> <overlay dtb>...", argv[0]);
+	n = argc - 2;
+
+	size = 0;
+	load_overlays(n, argv + 2, fdtos);
+	for (i = 0; i < n; i++)
+		size += fdt_totalsize(fdtos[i]);
+
+	/* Reference result: one overlay at a time, in place */
+	seq = load_blob(argv[1]);
+	for (i = 0; i < n; i++) {
+		seq = apply_in_place(seq, argv[i + 2]);
+		free(fdtos[i]);
+	}
+
+	/* One at a time with room to spare: each overlay gets rebuilt in */
+	many = open_base(argv[1], 4 * (size + 4096));
+	load_overlays(n, argv + 2, fdtos);
+	for (i = 0; i < n; i++) {
+		err = fdt_overlay_apply(many, fdtos[i]);
+		if (err)
+			FAIL("fdt_overlay_apply(%d): %s", i, fdt_strerror(err));
+		free(fdtos[i]);
+	}
+	compare_trees(seq, many);
+	free(many);
+
+	/* Plenty of room: the tree gets rebuilt in one go */
+	many = open_base(argv[1], 4 * (size + 4096));
+	err = fdt_overlay_apply_many(many, load_overlays(n, argv + 2, fdtos),
+				     n);
+	if (err)
+		FAIL("fdt_overlay_apply_many(): %s", fdt_strerror(err));
+	compare_trees(seq, many);
+	for (i = 0; i < n; i++)
+		free(fdtos[i]);
+
+	free(many);
+
+	/* Just the room fdt_overlay_apply_many_size() works out is enough */
+	load_overlays(n, argv + 2, fdtos);
+	base = load_blob(argv[1]);
+	size = fdt_overlay_apply_many_size(base, fdtos, n);
+	if (size < 0)
+		FAIL("fdt_overlay_apply_many_size(): %s", fdt_strerror(size));
+	free(base);
+
+	many = open_base(argv[1], size);
+	err = fdt_overlay_apply_many(many, fdtos, n);
+	if (err)
+		FAIL("fdt_overlay_apply_many() sized: %s", fdt_strerror(err));
+	compare_trees(seq, many);
+	for (i = 0; i < n; i++)
+		free(fdtos[i]);
+	free(many);
+
+	/* Barely enough room: falls back to merging in place */
+	many = open_base(argv[1], fdt_totalsize(seq) + 256);
+	err = fdt_overlay_apply_many(many, load_overlays(n, argv + 2, fdtos),
+				     n);
+	if (err)
+		FAIL("fdt_overlay_apply_many() in place: %s",
+		     fdt_strerror(err));
+	compare_trees(seq, many);
+
+	PASS();
+}
@@ -0,0 +1,97 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_overlay_apply_max_phandle()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+/* 4k ought to be enough for anybody */
+#define FDT_COPY_SIZE	(4 * 1024)
+
+/* How far above the base tree's phandles to start the overlay's */
+#define PHANDLE_GAP	0x100
+
+static void *open_dt(const char *path)
+{
+	void *dt, *copy;
+	int err;
+
+	dt = load_blob(path);
+	copy = xmalloc(FDT_COPY_SIZE);
+
+	err = fdt_open_into(dt, copy, FDT_COPY_SIZE);
+	if (err)
+		FAIL("fdt_open_into(%s): %s", path, fdt_strerror(err));
+	free(dt);
+
+	return copy;
+}
+
+static void apply(const char *base, const char *overlay, uint32_t gap)
+{
+	void *fdt, *fdto;
+	uint32_t start, max_phandle;
+	int err;
+
+	fdt = open_dt(base);
+	fdto = open_dt(overlay);
+
+	start = fdt_get_max_phandle(fdt) + gap;
+	max_phandle = start;
+	err = fdt_overlay_apply_max_phandle(fdt, fdto, &max_phandle);
+	if (err)
+		FAIL("fdt_overlay_apply_max_phandle(): %s", fdt_strerror(err));
+
+	/*
+	 * The overlay's phandles, if any, go above the one passed in,
+	 * and the highest of them is passed back
+	 */
+	if (max_phandle < start)
+		FAIL("fdt_overlay_apply_max_phandle() lowered max phandle"
+		     " from 0x%x to 0x%x", start, max_phandle);
+	if ((max_phandle > start)
+	    && (max_phandle != fdt_get_max_phandle(fdt)))
+		FAIL("fdt_overlay_apply_max_phandle() left max phandle 0x%x"
+		     " instead of 0x%x", max_phandle,
+		     fdt_get_max_phandle(fdt));
+	if (fdt_get_max_phandle(fdt) > max_phandle)
+		FAIL("Max phandle 0x%x is above the 0x%x passed back",
+		     fdt_get_max_phandle(fdt), max_phandle);
+
+	free(fdto);
+	free(fdt);
+}
+
+int main(int argc, char *argv[])
+{
+	test_init(argc, argv);
+	if (argc != 3)
+		CONFIG("Usage: %s <base dtb> <overlay dtb>", argv[0]);
+
+	/* Starting from the base tree's own max phandle */
+	apply(argv[1], argv[2], 0);
+
+	/* And from a higher one, as if earlier overlays had used more */
+	apply(argv[1], argv[2], PHANDLE_GAP);
+
+	PASS();
+}
@@ -0,0 +1,81 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_overlay_size_needed()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+int main(int argc, char *argv[])
+{
+	void *base, *fdt, *fdto;
+	uint32_t max_phandle;
+	int basesize, needed, ret, i;
+
+	test_init(argc, argv);
+	if (argc < 3)
+		CONFIG("Usage: %s <base dtb> <overlay dtb>...", argv[0]);
+
+	base = load_blob(argv[1]);
+	basesize = fdt_totalsize(base);
+
+	/* Size every overlay against the unmodified base */
+	needed = 0;
+	for (i = 2; i < argc; i++) {
+		fdto = load_blob(argv[i]);
+		ret = fdt_overlay_size_needed(base, fdto);
+		if (ret < 0)
+			FAIL("fdt_overlay_size_needed(%s): %s", argv[i],
+			     fdt_strerror(ret));
+		needed += ret;
+		free(fdto);
+	}
+
+	/* Then apply them all in exactly that much room */
+	fdt = xmalloc(basesize + needed);
+	ret = fdt_open_into(base, fdt, basesize + needed);
+	if (ret)
+		FAIL("fdt_open_into(): %s", fdt_strerror(ret));
+
+	max_phandle = fdt_get_max_phandle(fdt);
+	for (i = 2; i < argc; i++) {
+		fdto = load_blob(argv[i]);
+		ret = fdt_overlay_apply_max_phandle(fdt, fdto, &max_phandle);
+		if (ret)
+			FAIL("fdt_overlay_apply(%s): %s", argv[i],
+			     fdt_strerror(ret));
+		free(fdto);
+	}
+
+	ret = fdt_pack(fdt);
+	if (ret)
+		FAIL("fdt_pack(): %s", fdt_strerror(ret));
+
+	/* A single overlay of the test trees is sized exactly */
+	if ((argc == 3) && (fdt_totalsize(fdt) != basesize + needed))
+		FAIL("Overlay needed %d bytes, not %d",
+		     fdt_totalsize(fdt) - basesize, needed);
+
+	free(fdt);
+	free(base);
+	PASS();
+}
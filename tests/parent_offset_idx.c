@@ -0,0 +1,168 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_node_index_build() and the functions using it
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+#define PATH_MAX_LEN	256
+
+static void check_path(void *fdt, const void *idx, int offset)
+{
+	char path[PATH_MAX_LEN], path_idx[PATH_MAX_LEN];
+	int err, err_idx, len;
+
+	err = fdt_get_path(fdt, offset, path, sizeof(path));
+	err_idx = fdt_get_path_idx(fdt, idx, offset, path_idx,
+				   sizeof(path_idx));
+
+	if (err_idx != err)
+		FAIL("fdt_get_path_idx(%d) returns %d instead of %d",
+		     offset, err_idx, err);
+	if (err)
+		return;
+	if (strcmp(path_idx, path))
+		FAIL("fdt_get_path_idx(%d) gives \"%s\" instead of \"%s\"",
+		     offset, path_idx, path);
+
+	/* The path must fit exactly, and not in a byte less */
+	len = strlen(path);
+	err_idx = fdt_get_path_idx(fdt, idx, offset, path_idx, len + 1);
+	if (err_idx || strcmp(path_idx, path))
+		FAIL("fdt_get_path_idx(%d) into %d bytes: %s",
+		     offset, len + 1, fdt_strerror(err_idx));
+
+	err_idx = fdt_get_path_idx(fdt, idx, offset, path_idx, len);
+	if (err_idx != -FDT_ERR_NOSPACE)
+		FAIL("fdt_get_path_idx(%d) into %d bytes returns %d instead "
+		     "of -FDT_ERR_NOSPACE", offset, len, err_idx);
+}
+
+static void check_node(void *fdt, const void *idx, int offset)
+{
+	int ret, ret_idx, depth, depth_idx, d;
+
+	ret = fdt_parent_offset(fdt, offset);
+	ret_idx = fdt_parent_offset_idx(fdt, idx, offset);
+	if (ret_idx != ret)
+		FAIL("fdt_parent_offset_idx(%d) returns %d instead of %d",
+		     offset, ret_idx, ret);
+
+	ret = fdt_node_depth(fdt, offset);
+	ret_idx = fdt_node_depth_idx(fdt, idx, offset);
+	if (ret_idx != ret)
+		FAIL("fdt_node_depth_idx(%d) returns %d instead of %d",
+		     offset, ret_idx, ret);
+
+	for (d = -1; d <= ((ret < 0) ? 0 : ret + 1); d++) {
+		depth = depth_idx = -1;
+		ret = fdt_supernode_atdepth_offset(fdt, offset, d, &depth);
+		ret_idx = fdt_supernode_atdepth_offset_idx(fdt, idx, offset, d,
+							   &depth_idx);
+		if ((ret_idx != ret) || (depth_idx != depth))
+			FAIL("fdt_supernode_atdepth_offset_idx(%d, %d) "
+			     "returns %d (depth %d) instead of %d (depth %d)",
+			     offset, d, ret_idx, depth_idx, ret, depth);
+	}
+
+	check_path(fdt, idx, offset);
+}
+
+static void check_tree(void *fdt, const void *idx)
+{
+	int offset;
+
+	for (offset = 0; offset >= 0; offset = fdt_next_node(fdt, offset, NULL))
+		check_node(fdt, idx, offset);
+
+	/* Offsets which aren't nodes must fail in the same way */
+	check_node(fdt, idx, -1);
+	check_node(fdt, idx, 4);
+}
+
+int main(int argc, char *argv[])
+{
+	void *fdt, *idx, *rw, *rwidx;
+	int size, rwsize, err, offset;
+
+	test_init(argc, argv);
+	fdt = load_blob_arg(argc, argv);
+
+	size = fdt_node_index_size(fdt);
+	if (size < 0)
+		FAIL("fdt_node_index_size(): %s", fdt_strerror(size));
+	idx = xmalloc(size);
+
+	err = fdt_node_index_build(fdt, idx, size - 1);
+	if (err != -FDT_ERR_NOSPACE)
+		FAIL("fdt_node_index_build() into short buffer returns %d "
+		     "instead of -FDT_ERR_NOSPACE", err);
+
+	err = fdt_node_index_build(fdt, idx, size);
+	if (err)
+		FAIL("fdt_node_index_build(): %s", fdt_strerror(err));
+
+	check_tree(fdt, idx);
+
+	/* Changes through the read-write functions mark the index stale,
+	 * even ones that leave the structure block the same size */
+	rwsize = fdt_totalsize(fdt) + 1024;
+	rw = xmalloc(rwsize);
+	err = fdt_open_into(fdt, rw, rwsize);
+	if (err)
+		FAIL("fdt_open_into(): %s", fdt_strerror(err));
+
+	rwidx = xmalloc(size);
+	err = fdt_node_index_build(rw, rwidx, size);
+	if (err)
+		FAIL("fdt_node_index_build(): %s", fdt_strerror(err));
+	check_tree(rw, rwidx);
+
+	shift_nodes(rw);
+	check_tree(rw, rwidx);
+
+	free(rwidx);
+	free(rw);
+
+	/* Once marked stale after modifying the tree, the index must no
+	 * longer answer lookups */
+	offset = fdt_first_subnode(fdt, 0);
+	if (offset < 0)
+		FAIL("fdt_first_subnode(): %s", fdt_strerror(offset));
+	err = fdt_nop_node(fdt, offset);
+	if (err)
+		FAIL("fdt_nop_node(): %s", fdt_strerror(err));
+	fdt_index_invalidate(idx);
+	check_tree(fdt, idx);
+
+	err = fdt_node_index_build(fdt, idx, size);
+	if (err)
+		FAIL("fdt_node_index_build(): %s", fdt_strerror(err));
+	check_tree(fdt, idx);
+
+	/* A missing index falls back to scanning */
+	check_tree(fdt, NULL);
+
+	free(idx);
+	PASS();
+}
@@ -0,0 +1,157 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for fdt_path_offset_cached() / fdt_get_alias_cached()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+#define CACHE_SIZE	4096
+
+static void check_path(void *fdt, void *cache, const char *path)
+{
+	int offset, cached;
+
+	offset = fdt_path_offset(fdt, path);
+	cached = fdt_path_offset_cached(fdt, cache, path);
+
+	if (cached != offset)
+		FAIL("fdt_path_offset_cached(\"%s\") returns %d instead of %d",
+		     path, cached, offset);
+}
+
+static void check_alias(void *fdt, void *cache, const char *name)
+{
+	const char *alias, *cached;
+
+	alias = fdt_get_alias(fdt, name);
+	cached = fdt_get_alias_cached(fdt, cache, name);
+
+	if (cached != alias)
+		FAIL("fdt_get_alias_cached(\"%s\") returns %s instead of %s",
+		     name, cached ? cached : "NULL", alias ? alias : "NULL");
+}
+
+/* Look every node up by its path, and by its path without the unit
+ * address of the last component, and every alias by name, twice so
+ * the second lookups come from the cache */
+static void check_tree(void *fdt, void *cache)
+{
+	char path[256];
+	const char *name;
+	char *at;
+	int offset, aliases, property, err, pass;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (offset = 0; offset >= 0;
+		     offset = fdt_next_node(fdt, offset, NULL)) {
+			err = fdt_get_path(fdt, offset, path, sizeof(path));
+			if (err)
+				FAIL("fdt_get_path(): %s", fdt_strerror(err));
+
+			check_path(fdt, cache, path);
+
+			at = strrchr(path, '@');
+			if (at && !strchr(at, '/')) {
+				*at = '\0';
+				check_path(fdt, cache, path);
+			}
+		}
+
+		aliases = fdt_path_offset(fdt, "/aliases");
+		if (aliases < 0)
+			continue;
+
+		fdt_for_each_property_offset(property, fdt, aliases) {
+			if (!fdt_getprop_by_offset(fdt, property, &name, NULL))
+				FAIL("fdt_getprop_by_offset() failed");
+
+			check_alias(fdt, cache, name);
+			check_path(fdt, cache, name);
+		}
+
+		check_alias(fdt, cache, "no-such-alias");
+		check_path(fdt, cache, "no-such-alias");
+		check_path(fdt, cache, "/no-such-node");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	void *fdt, *cache, *rw;
+	int err, offset, size;
+
+	test_init(argc, argv);
+	fdt = load_blob_arg(argc, argv);
+	cache = xmalloc(CACHE_SIZE);
+
+	err = fdt_path_cache_init(fdt, cache, 1);
+	if (err != -FDT_ERR_NOSPACE)
+		FAIL("fdt_path_cache_init() into short buffer returns %d "
+		     "instead of -FDT_ERR_NOSPACE", err);
+
+	/* A cache of a slot or two gets overwritten all the time */
+	err = fdt_path_cache_init(fdt, cache, 64);
+	if (err)
+		FAIL("fdt_path_cache_init(): %s", fdt_strerror(err));
+	check_tree(fdt, cache);
+
+	err = fdt_path_cache_init(fdt, cache, CACHE_SIZE);
+	if (err)
+		FAIL("fdt_path_cache_init(): %s", fdt_strerror(err));
+	check_tree(fdt, cache);
+
+	/* Once marked stale after modifying the tree, the cache must no
+	 * longer answer lookups */
+	offset = fdt_first_subnode(fdt, 0);
+	if (offset < 0)
+		FAIL("fdt_first_subnode(): %s", fdt_strerror(offset));
+	err = fdt_nop_node(fdt, offset);
+	if (err)
+		FAIL("fdt_nop_node(): %s", fdt_strerror(err));
+	fdt_index_invalidate(cache);
+	check_tree(fdt, cache);
+
+	/* So does any change through the read-write functions, even one
+	 * that leaves the structure block the same size */
+	size = fdt_totalsize(fdt) + 1024;
+	rw = xmalloc(size);
+	err = fdt_open_into(fdt, rw, size);
+	if (err)
+		FAIL("fdt_open_into(): %s", fdt_strerror(err));
+
+	err = fdt_path_cache_init(rw, cache, CACHE_SIZE);
+	if (err)
+		FAIL("fdt_path_cache_init(): %s", fdt_strerror(err));
+	check_tree(rw, cache);
+
+	shift_nodes(rw);
+	check_tree(rw, cache);
+
+	free(rw);
+
+	/* A missing cache falls back to scanning */
+	check_tree(fdt, NULL);
+
+	free(cache);
+	PASS();
+}
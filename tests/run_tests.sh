@@ -191,6 +191,7 @@ libfdt_overlay_tests () {
     run_test check_path overlay_overlay_no_fixups.test.dtb exists "/__local_fixups__"
 
     run_test overlay overlay_base_no_symbols.test.dtb overlay_overlay_no_fixups.test.dtb
+    run_test overlay_max_phandle overlay_base_no_symbols.test.dtb overlay_overlay_no_fixups.test.dtb
 
     # Then test with manually constructed fixups
     run_dtc_test -I dts -O dtb -o overlay_base_manual_symbols.test.dtb overlay_base_manual_symbols.dts
@@ -204,12 +205,14 @@ libfdt_overlay_tests () {
     run_test check_path overlay_overlay_manual_fixups.test.dtb exists "/__local_fixups__"
 
     run_test overlay overlay_base_manual_symbols.test.dtb overlay_overlay_manual_fixups.test.dtb
+    run_test overlay_max_phandle overlay_base_manual_symbols.test.dtb overlay_overlay_manual_fixups.test.dtb
 
     # Bad fixup tests
     for test in $BAD_FIXUP_TREES; do
 	tree="overlay_bad_fixup_$test"
 	run_dtc_test -I dts -O dtb -o $tree.test.dtb $tree.dts
 	run_test overlay_bad_fixup overlay_base_no_symbols.test.dtb $tree.test.dtb
+	run_test overlay_apply_into overlay_base_no_symbols.test.dtb $tree.test.dtb
     done
 }
 
@@ -220,6 +223,8 @@ dtc_overlay_tests () {
     run_test check_path overlay_base.test.dtb exists "/__symbols__"
     run_test check_path overlay_base.test.dtb not-exists "/__fixups__"
     run_test check_path overlay_base.test.dtb not-exists "/__local_fixups__"
+    run_test node_offset_by_symbol_idx overlay_base.test.dtb
+    run_test node_offset_by_symbol_idx test_tree1.dtb
 
     run_dtc_test -I dts -O dtb -o overlay_overlay.test.dtb overlay_overlay.dts
     run_test check_path overlay_overlay.test.dtb not-exists "/__symbols__"
@@ -227,6 +232,23 @@ dtc_overlay_tests () {
     run_test check_path overlay_overlay.test.dtb exists "/__local_fixups__"
 
     run_test overlay overlay_base.test.dtb overlay_overlay.test.dtb
+    run_test overlay_max_phandle overlay_base.test.dtb overlay_overlay.test.dtb
+
+    # Test applying several overlays at once, the second one building
+    # on nodes added by the first
+    run_dtc_test -I dts -O dtb -o overlay_overlay_stacked.test.dtb overlay_overlay_stacked.dts
+    run_test overlay_apply_many overlay_base.test.dtb overlay_overlay.test.dtb overlay_overlay_stacked.test.dtb
+    run_dtc_test -I dts -O dtb -o overlay_overlay_simple.test.dtb overlay_overlay_simple.dts
+    run_test overlay_apply_many overlay_base.test.dtb overlay_overlay.test.dtb overlay_overlay_simple.test.dtb
+
+    # Test sizing overlays before applying them
+    run_test overlay_size_needed overlay_base.test.dtb overlay_overlay.test.dtb
+    run_test overlay_size_needed overlay_base.test.dtb overlay_overlay_simple.test.dtb
+    run_test overlay_size_needed overlay_base.test.dtb overlay_overlay.test.dtb overlay_overlay_stacked.test.dtb
+
+    # Test applying an overlay into a separate buffer
+    run_test overlay_apply_into overlay_base.test.dtb overlay_overlay.test.dtb
+    run_test overlay_apply_into overlay_base.test.dtb overlay_overlay_simple.test.dtb
 
     # test plugin source to dtb and back
     run_dtc_test -I dtb -O dts -o overlay_overlay_decompile.test.dts overlay_overlay.test.dtb
@@ -250,14 +272,17 @@ tree1_tests () {
     run_test find_property $TREE
     run_test subnode_offset $TREE
     run_test path_offset $TREE
+    run_test path_offset_cached $TREE
     run_test get_name $TREE
     run_test getprop $TREE
     run_test get_phandle $TREE
     run_test get_path $TREE
     run_test supernode_atdepth_offset $TREE
     run_test parent_offset $TREE
+    run_test parent_offset_idx $TREE
     run_test node_offset_by_prop_value $TREE
     run_test node_offset_by_phandle $TREE
+    run_test node_offset_by_phandle_idx $TREE
     run_test node_check_compatible $TREE
     run_test node_offset_by_compatible $TREE
     run_test notfound $TREE
@@ -376,6 +401,7 @@ libfdt_tests () {
     run_dtc_test -I dts -O dtb -o aliases.dtb aliases.dts
     run_test get_alias aliases.dtb
     run_test path_offset_aliases aliases.dtb
+    run_test path_offset_cached aliases.dtb
 
     # Specific bug tests
     run_test add_subnode_with_nops
@@ -472,6 +498,13 @@ dtc_tests () {
     run_dtc_test -I dtb -O dtb -b0 -o override0_boot_cpuid_17.test.dtb boot_cpuid_17.test.dtb
     run_test boot-cpuid override0_boot_cpuid_17.test.dtb 0
 
+    # Check relaying out a blob without its tree
+    run_dtc_test -I dtb -O dtb -p 100 -o relayout_boot_cpuid.test.dtb boot_cpuid.test.dtb
+    run_test dtbs_equal_ordered relayout_boot_cpuid.test.dtb boot_cpuid.test.dtb
+    run_dtc_test -I dtb -O dtb -a 512 -b 17 -o relayout17_boot_cpuid.test.dtb boot_cpuid.test.dtb
+    run_test boot-cpuid relayout17_boot_cpuid.test.dtb 17
+    run_sh_test dtc-checkfails.sh node_name_chars -- --check -I dtb -O dtb -p 100 bad_node_char.dtb
+
 
     # Check -Oasm mode
     for tree in test_tree1.dts escapes.dts references.dts path-references.dts \
@@ -482,6 +515,7 @@ dtc_tests () {
 	run_dtc_test -I dts -O dtb -o $tree.test.dtb $tree
 	run_test asm_tree_dump ./oasm_$tree.test.so oasm_$tree.test.dtb
 	run_wrap_test cmp oasm_$tree.test.dtb $tree.test.dtb
+	run_test string_offsets $tree.test.dtb
     done
 
     run_test value-labels ./oasm_value-labels.dts.test.so
@@ -576,6 +610,34 @@ dtc_tests () {
     run_sh_test dtc-fails.sh -n test-negation-4.test.dtb -Esize_cells_is_cell -Eno_size_cells_is_cell -I dts -O dtb bad-ncells.dts
     run_sh_test dtc-checkfails.sh size_cells_is_cell -- -Esize_cells_is_cell -Eno_size_cells_is_cell -I dts -O dtb bad-ncells.dts
 
+    # Check running checks in parallel
+    run_sh_test dtc-checkfails.sh address_cells_is_cell size_cells_is_cell interrupt_cells_is_cell -- -j 4 -I dts -O dtb bad-ncells.dts
+    run_sh_test dtc-checkfails.sh duplicate_label -- -j 4 -I dts -O dtb reuse-label1.dts
+    run_dtc_test -j 4 -I dts -O dtb -o jobs_dtc_tree1.test.dtb test_tree1.dts
+    run_wrap_test cmp jobs_dtc_tree1.test.dtb dtc_tree1.test.dtb
+
+    # Check that --stats leaves the output alone
+    run_dtc_test --stats -I dts -O dtb -o stats_dtc_tree1.test.dtb test_tree1.dts
+    run_wrap_test cmp stats_dtc_tree1.test.dtb dtc_tree1.test.dtb
+
+    # Check --share-suffixes only moves names around in the strings block
+    run_dtc_test --share-suffixes -I dts -O dtb -o share_dtc_tree1.test.dtb test_tree1.dts
+    run_test dtbs_equal_ordered share_dtc_tree1.test.dtb dtc_tree1.test.dtb
+    run_dtc_test --share-suffixes -I dts -O dtb -o share_aliases.test.dtb aliases.dts
+    run_test dtbs_equal_ordered share_aliases.test.dtb aliases.dts.test.dtb
+
+    # Check rewriting a blob in place, which it can't borrow values from
+    run_wrap_test cp dtc_tree1.test.dtb inplace_dtc_tree1.test.dtb
+    run_dtc_test -I dtb -O dtb -o inplace_dtc_tree1.test.dtb inplace_dtc_tree1.test.dtb
+    run_test dtbs_equal_ordered inplace_dtc_tree1.test.dtb dtc_tree1.test.dtb
+    run_wrap_test cp dtc_tree1.test.dtb inplace_stdin_dtc_tree1.test.dtb
+    run_dtc_test -I dtb -O dtb -o inplace_stdin_dtc_tree1.test.dtb - < inplace_stdin_dtc_tree1.test.dtb
+    run_test dtbs_equal_ordered inplace_stdin_dtc_tree1.test.dtb dtc_tree1.test.dtb
+    run_wrap_test cp dtc_tree1.test.dtb inplace_stdin_dtc_tree1.test.dts
+    run_dtc_test -I dtb -O dts -o inplace_stdin_dtc_tree1.test.dts - < inplace_stdin_dtc_tree1.test.dts
+    run_dtc_test -I dts -O dtb -o inplace_stdin_dtc_tree1_dts.test.dtb inplace_stdin_dtc_tree1.test.dts
+    run_test dtbs_equal_ordered inplace_stdin_dtc_tree1_dts.test.dtb dtc_tree1.test.dtb
+
     # Check for proper behaviour reading from stdin
     run_dtc_test -I dts -O dtb -o stdin_dtc_tree1.test.dtb - < test_tree1.dts
     run_wrap_test cmp stdin_dtc_tree1.test.dtb dtc_tree1.test.dtb
@@ -692,6 +754,25 @@ fdtget_tests () {
     run_fdtget_test "<the dead silence>" -tx \
 	-d "<the dead silence>" $dtb /randomnode doctor-who
     run_fdtget_test "<blink>" -tx -d "<blink>" $dtb /memory doctor-who
+
+    # Test queries read from a file, repeating and revisiting nodes
+    queries=fdtget-queries.test.txt
+    printf '%s\n' "# comment" "/ model" "" "/cpus/PowerPC,970@1 d-cache-size" \
+	"/cpus/PowerPC,970@1 d-cache-size" "/memory device_type" \
+	"/cpus//PowerPC,970@1/ d-cache-size" > $queries
+    run_fdtget_test "MyBoardName\n32768\n32768\nmemory\n32768" -f $queries $dtb
+    run_fdtget_test "memory\nMyBoardName\n32768\n32768\nmemory\n32768" \
+	-f $queries $dtb /memory device_type
+    printf '%s\n' "/randomnode doctor-who" "/no-such-node model" > $queries
+    run_fdtget_test "<none>\n<none>" -d "<none>" -f $queries $dtb
+    printf '%s\n' "/cpus" "/" > $queries
+    run_fdtget_test "PowerPC,970@0\nPowerPC,970@1\ncpus\nrandomnode\nmemory@0\nchosen" \
+	-l -f $queries $dtb
+    printf '%s\n' "/ model" "/randomnode doctor-who" "/ compatible" > $queries
+    run_wrap_error_test $DTGET -f $queries $dtb
+    printf '%s\n' "/ model extra" > $queries
+    run_wrap_error_test $DTGET -f $queries $dtb
+    run_wrap_error_test $DTGET -f no-such-file.test.txt $dtb
 }
 
 fdtput_tests () {
@@ -768,6 +849,38 @@ fdtput_tests () {
     # Delete the non-existent property
     run_wrap_error_test $DTPUT $dtb -d /chosen   non-existent-prop
 
+    # Script of operations, applied in one go
+    script=fdtput-script.test.txt
+    run_dtc_test -O dtb -o $dtb $dts
+    printf '%s\n' "# comment" "" "set / model 'a model'" \
+	"set -tx /cpus/PowerPC,970@1 d-cache-size 0x8001" \
+	"create /chosen/node1 /chosen/node2" "remove /chosen/node1" \
+	"set -ts /chosen/node2 greeting \"hello, \\\"world\\\"\" again" \
+	"delete /chosen bootargs" "set /chosen/node2 empty" > $script
+    run_wrap_test $DTPUT -ts -f $script $dtb
+    run_fdtget_test "a model" $dtb / model
+    run_fdtget_test "8001" -tx $dtb /cpus/PowerPC,970@1 d-cache-size
+    run_fdtget_test "node2" $dtb -l /chosen
+    run_fdtget_test "linux,platform" $dtb -p /chosen
+    run_fdtget_test 'hello, "world" again' $dtb /chosen/node2 greeting
+    run_fdtget_test "" $dtb /chosen/node2 empty
+    printf '%s\n' "set -ts / model two" "set -ts /blackadder/the-second/potato drink wine" > $script
+    run_wrap_test $DTPUT -p -f $script $dtb / compatible -ts one
+    run_fdtget_test "one\ntwo\nwine" $dtb / compatible / model /blackadder/the-second/potato drink
+
+    # A failing script leaves the blob alone
+    printf '%s\n' "set -ts / model three" "remove /non-existent/node" > $script
+    run_wrap_error_test $DTPUT -f $script $dtb
+    printf '%s\n' "set -ts / model 'three" > $script
+    run_wrap_error_test $DTPUT -f $script $dtb
+    printf '%s\n' "rename / model" > $script
+    run_wrap_error_test $DTPUT -f $script $dtb
+    printf '%s\n' "set /" > $script
+    run_wrap_error_test $DTPUT -f $script $dtb
+    printf '%s\n' "set -t" > $script
+    run_wrap_error_test $DTPUT -f $script $dtb
+    run_fdtget_test "two" $dtb / model
+
     # TODO: Add tests for verbose mode?
 }
 
@@ -791,6 +904,17 @@ fdtoverlay_tests() {
 
     # test that the new property is installed
     run_fdtoverlay_test foobar "/test-node" "test-str-property" "-ts" ${basedtb} ${targetdtb} ${overlaydtb}
+
+    # test that later overlays win when several are applied at once
+    stackeddtb=overlay_overlay_stacked.fdoverlay.test.dtb
+    run_dtc_test -@ -I dts -O dtb -o $stackeddtb overlay_overlay_stacked.dts
+    run_fdtoverlay_test stacked "/test-node" "test-str-property" "-ts" ${basedtb} ${targetdtb} ${overlaydtb} ${stackeddtb}
+    run_fdtoverlay_test 1 "/test-node/new-node" "stacked-property" "-tu" ${basedtb} ${targetdtb} ${overlaydtb} ${stackeddtb}
+
+    # test that a truncated overlay is refused
+    truncdtb=overlay_overlay_truncated.fdoverlay.test.dtb
+    head -c 100 $overlaydtb > $truncdtb
+    run_wrap_error_test $FDTOVERLAY -i $basedtb -o $targetdtb $truncdtb
 }
 
 pylibfdt_tests () {
@@ -0,0 +1,89 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ *	Testcase for the layout of dtc's strings block: checks it is
+ *	exactly what dtc's original linear search for each property
+ *	name, in structure block order, would have produced
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <libfdt.h>
+
+#include "tests.h"
+
+/* The first match of @name anywhere in @strings, ending on a nul, or
+ * -1 if there is none */
+static int linear_search(const char *strings, int len, const char *name)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		if (streq(strings + i, name))
+			return i;
+
+	return -1;
+}
+
+int main(int argc, char *argv[])
+{
+	void *fdt;
+	const struct fdt_property *prop;
+	const char *name;
+	char *strings;
+	int node, property, offset, len = 0, namelen;
+
+	test_init(argc, argv);
+	fdt = load_blob_arg(argc, argv);
+
+	strings = xmalloc(fdt_size_dt_strings(fdt) + 1);
+
+	for (node = 0; node >= 0; node = fdt_next_node(fdt, node, NULL))
+		fdt_for_each_property_offset(property, fdt, node) {
+			prop = fdt_get_property_by_offset(fdt, property, NULL);
+			if (!prop)
+				FAIL("fdt_get_property_by_offset() failed");
+			name = fdt_string(fdt, fdt32_to_cpu(prop->nameoff));
+
+			offset = linear_search(strings, len, name);
+			if (offset < 0) {
+				namelen = strlen(name) + 1;
+				if (len + namelen > fdt_size_dt_strings(fdt))
+					FAIL("Strings block too short at \"%s\"",
+					     name);
+				offset = len;
+				memcpy(strings + len, name, namelen);
+				len += namelen;
+			}
+
+			if (fdt32_to_cpu(prop->nameoff) != offset)
+				FAIL("Property \"%s\" at %d names string offset "
+				     "%d instead of %d", name, property,
+				     fdt32_to_cpu(prop->nameoff), offset);
+		}
+
+	if (len != fdt_size_dt_strings(fdt))
+		FAIL("Strings block is %d bytes instead of %d",
+		     fdt_size_dt_strings(fdt), len);
+	if (memcmp(strings, (const char *)fdt + fdt_off_dt_strings(fdt), len))
+		FAIL("Strings block differs from the linear search's");
+
+	free(strings);
+	PASS();
+}
@@ -123,6 +123,7 @@ void *load_blob(const char *filename);
 void *load_blob_arg(int argc, char *argv[]);
 void save_blob(const char *filename, void *blob);
 void *open_blob_rw(void *blob);
+void shift_nodes(void *fdt);
 
 #include "util.h"
 
@@ -200,3 +200,57 @@ void *open_blob_rw(void *blob)
 		FAIL("fdt_open_into(): %s", fdt_strerror(err));
 	return buf;
 }
+
+/* Shift some nodes along without changing the size of the structure
+ * block: grow the tree's first property by 4 bytes, then shrink the
+ * last property with a suitable length by as much.  Needs at least 4
+ * bytes of free space in the tree. */
+void shift_nodes(void *fdt)
+{
+	static const char zero[4];
+	const char *name;
+	const void *val;
+	char *firstname = NULL, *lastname = NULL;
+	void *copy;
+	int size, node, offset, first = -1, last = -1, len, err;
+
+	size = fdt_size_dt_struct(fdt);
+
+	for (node = 0; node >= 0; node = fdt_next_node(fdt, node, NULL))
+		fdt_for_each_property_offset(offset, fdt, node) {
+			fdt_getprop_by_offset(fdt, offset, &name, &len);
+			if (first < 0) {
+				firstname = xstrdup(name);
+				first = node;
+			} else if ((len >= 4) && !(len % 4)) {
+				free(lastname);
+				lastname = xstrdup(name);
+				last = node;
+			}
+		}
+	if (last < 0)
+		FAIL("No properties to grow and shrink");
+
+	err = fdt_appendprop(fdt, first, firstname, zero, sizeof(zero));
+	if (err)
+		FAIL("fdt_appendprop(\"%s\"): %s", firstname,
+		     fdt_strerror(err));
+	if (last != first)
+		last += sizeof(zero);
+
+	val = fdt_getprop(fdt, last, lastname, &len);
+	if (!val)
+		FAIL("fdt_getprop(\"%s\"): %s", lastname, fdt_strerror(len));
+	copy = xmalloc(len);
+	memcpy(copy, val, len);
+	err = fdt_setprop(fdt, last, lastname, copy, len - 4);
+	if (err)
+		FAIL("fdt_setprop(\"%s\"): %s", lastname, fdt_strerror(err));
+	free(copy);
+	free(firstname);
+	free(lastname);
+
+	if (fdt_size_dt_struct(fdt) != size)
+		FAIL("Structure block changed size from %d to %d",
+		     size, fdt_size_dt_struct(fdt));
+}
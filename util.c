@@ -30,7 +30,10 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "libfdt.h"
 #include "util.h"
@@ -100,6 +103,14 @@ char *join_path(const char *path, const char *name)
 	return str;
 }
 
+double util_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 bool util_is_printable_string(const void *data, int len)
 {
 	const char *s = data;
@@ -227,19 +238,16 @@ char get_escape_char(const char *s, int *i)
 	return val;
 }
 
-int utilfdt_read_err_len(const char *filename, char **buffp, off_t *len)
+static int utilfdt_read_fd(int fd, char **buffp, off_t *len)
 {
-	int fd = 0;	/* assume stdin */
 	char *buf = NULL;
 	off_t bufsize = 1024, offset = 0;
+	struct stat st;
 	int ret = 0;
 
-	*buffp = NULL;
-	if (strcmp(filename, "-") != 0) {
-		fd = open(filename, O_RDONLY);
-		if (fd < 0)
-			return errno;
-	}
+	/* Size the buffer up front when we know how much there is */
+	if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size >= bufsize)
+		bufsize = st.st_size + 1;
 
 	/* Loop until we have read everything */
 	buf = xmalloc(bufsize);
@@ -258,13 +266,30 @@ int utilfdt_read_err_len(const char *filename, char **buffp, off_t *len)
 		offset += ret;
 	} while (ret != 0);
 
-	/* Clean up, including closing stdin; return errno on error */
-	close(fd);
 	if (ret)
 		free(buf);
 	else
 		*buffp = buf;
-	*len = bufsize;
+	*len = offset;
+	return ret;
+}
+
+int utilfdt_read_err_len(const char *filename, char **buffp, off_t *len)
+{
+	int fd = 0;	/* assume stdin */
+	int ret;
+
+	*buffp = NULL;
+	if (strcmp(filename, "-") != 0) {
+		fd = open(filename, O_RDONLY);
+		if (fd < 0)
+			return errno;
+	}
+
+	ret = utilfdt_read_fd(fd, buffp, len);
+
+	/* Clean up, including closing stdin; return errno on error */
+	close(fd);
 	return ret;
 }
 
@@ -294,6 +319,87 @@ char *utilfdt_read(const char *filename)
 	return utilfdt_read_len(filename, &len);
 }
 
+/* An empty blob still gets a (one byte) mapping */
+static size_t utilfdt_map_size(off_t len)
+{
+	return len > 0 ? len : 1;
+}
+
+int utilfdt_map_err_len(const char *filename, int writable, char **buffp,
+			off_t *len)
+{
+	int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+	int fd = 0;	/* assume stdin */
+	struct stat st;
+	char *buf, *copy;
+	int ret;
+
+	*buffp = NULL;
+	if (strcmp(filename, "-") != 0) {
+		fd = open(filename, O_RDONLY);
+		if (fd < 0)
+			return errno;
+	}
+
+	/*
+	 * Map regular files directly.  The mapping is private, so any
+	 * changes made to a writable blob never reach the file.
+	 */
+	if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+		buf = mmap(NULL, st.st_size, prot, MAP_PRIVATE, fd, 0);
+		if (buf != MAP_FAILED) {
+			close(fd);
+			*buffp = buf;
+			*len = st.st_size;
+			return 0;
+		}
+	}
+
+	/*
+	 * Anything else (stdin, pipes, or a file we could not map) is
+	 * read as usual, then moved into an anonymous mapping so that
+	 * utilfdt_unmap() can release the blob either way.
+	 */
+	ret = utilfdt_read_fd(fd, &buf, len);
+	close(fd);
+	if (ret)
+		return ret;
+
+	copy = mmap(NULL, utilfdt_map_size(*len), PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (copy == MAP_FAILED) {
+		ret = errno;
+		free(buf);
+		return ret;
+	}
+	memcpy(copy, buf, *len);
+	free(buf);
+	if (!writable)
+		mprotect(copy, utilfdt_map_size(*len), PROT_READ);
+
+	*buffp = copy;
+	return 0;
+}
+
+char *utilfdt_map_len(const char *filename, int writable, off_t *len)
+{
+	char *buff;
+	int ret = utilfdt_map_err_len(filename, writable, &buff, len);
+
+	if (ret) {
+		fprintf(stderr, "Couldn't open blob from '%s': %s\n", filename,
+			strerror(ret));
+		return NULL;
+	}
+	/* Successful map */
+	return buff;
+}
+
+void utilfdt_unmap(char *blob, off_t len)
+{
+	munmap(blob, utilfdt_map_size(len));
+}
+
 int utilfdt_write_err(const char *filename, const void *blob)
 {
 	int fd = 1;	/* assume stdout */
@@ -71,6 +71,12 @@ extern char *xstrdup(const char *s);
 extern int PRINTF(2, 3) xasprintf(char **strp, const char *fmt, ...);
 extern char *join_path(const char *path, const char *name);
 
+/**
+ * Returns the time in seconds since some fixed point, for timing things.
+ * It is not affected by changes to the system clock.
+ */
+extern double util_time(void);
+
 /**
  * Check a property of a given length to see if it is all printable and
  * has a valid terminator. The property can contain either a single string,
@@ -124,6 +130,40 @@ int utilfdt_read_err(const char *filename, char **buffp);
  */
 int utilfdt_read_err_len(const char *filename, char **buffp, off_t *len);
 
+/**
+ * Map a device tree file into memory, without copying it when it is a
+ * regular file. Anything that cannot be mapped, such as stdin or a pipe,
+ * is read into memory instead. Does not report errors, but only returns
+ * them, like utilfdt_read_err().
+ *
+ * The blob is private to the caller: when writable, changes to it are
+ * never written back to the file. It cannot be resized, and must be
+ * released with utilfdt_unmap() rather than free().
+ *
+ * @param filename	The filename to map, or - for stdin
+ * @param writable	Non-zero if the caller needs to modify the blob
+ * @param buffp		Returns pointer to the mapped fdt
+ * @param len		Returns the size of the file mapped
+ * @return 0 if ok, else an errno value representing the error
+ */
+int utilfdt_map_err_len(const char *filename, int writable, char **buffp,
+			off_t *len);
+
+/**
+ * Like utilfdt_map_err_len(), but reports any errors on stderr.
+ *
+ * @return Pointer to the mapped fdt, or NULL on error
+ */
+char *utilfdt_map_len(const char *filename, int writable, off_t *len);
+
+/**
+ * Release a blob obtained from utilfdt_map_len() or utilfdt_map_err_len().
+ *
+ * @param blob		The mapped fdt
+ * @param len		Its size, as returned when it was mapped
+ */
+void utilfdt_unmap(char *blob, off_t len);
+
 /**
  * Write a device tree buffer to a file. This will report any errors on
  * stderr.